@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ActorPool.h"
+#include "Engine/World.h"
+
+UWorld* UActorPool::GetWorld() const
+{
+	return GetOuter() != nullptr ? GetOuter()->GetWorld() : nullptr;
+}
+
+AActor* UActorPool::AcquireActor(UClass* actorClass, const FTransform& transform)
+{
+	if (actorClass == nullptr)
+		return nullptr;
+
+	FPooledActors* pooledActors = mInactiveActors.Find(actorClass);
+
+	AActor* actor = nullptr;
+	while (actor == nullptr && pooledActors != nullptr && pooledActors->mActors.Num() > 0)
+	{
+		actor = pooledActors->mActors.Pop(false);
+
+		//..Something else may have destroyed it while it was in the pool.
+		if (actor != nullptr && actor->IsPendingKill())
+		{
+			actor = nullptr;
+		}
+	}
+
+	if (actor == nullptr)
+		return SpawnActor(actorClass, transform);
+
+	actor->SetActorTransform(transform, false, nullptr, ETeleportType::ResetPhysics);
+	actor->SetActorHiddenInGame(false);
+	actor->SetActorEnableCollision(true);
+	actor->SetActorTickEnabled(actor->PrimaryActorTick.bStartWithTickEnabled);
+
+	if (IPoolableActor* poolableActor = Cast<IPoolableActor>(actor))
+	{
+		poolableActor->OnAcquiredFromPool();
+	}
+
+	return actor;
+}
+
+void UActorPool::Release(AActor* actor)
+{
+	if (actor == nullptr || actor->IsPendingKill())
+		return;
+
+	Deactivate(actor);
+
+	mInactiveActors.FindOrAdd(actor->GetClass()).mActors.Add(actor);
+}
+
+void UActorPool::Prewarm(UClass* actorClass, int32 count)
+{
+	if (actorClass == nullptr)
+		return;
+
+	TArray<AActor*>& pooledActors = mInactiveActors.FindOrAdd(actorClass).mActors;
+	pooledActors.Reserve(count);
+
+	while (pooledActors.Num() < count)
+	{
+		AActor* actor = SpawnActor(actorClass, FTransform::Identity);
+		if (actor == nullptr)
+			return;
+
+		Deactivate(actor);
+		pooledActors.Add(actor);
+	}
+}
+
+int32 UActorPool::GetNumInactive(UClass* actorClass) const
+{
+	const FPooledActors* pooledActors = mInactiveActors.Find(actorClass);
+	return pooledActors != nullptr ? pooledActors->mActors.Num() : 0;
+}
+
+AActor* UActorPool::SpawnActor(UClass* actorClass, const FTransform& transform) const
+{
+	FActorSpawnParameters spawnInfo;
+	spawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	return GetWorld()->SpawnActor<AActor>(actorClass, transform, spawnInfo);
+}
+
+void UActorPool::Deactivate(AActor* actor) const
+{
+	if (IPoolableActor* poolableActor = Cast<IPoolableActor>(actor))
+	{
+		poolableActor->OnReturnedToPool();
+	}
+
+	actor->SetActorHiddenInGame(true);
+	actor->SetActorEnableCollision(false);
+	actor->SetActorTickEnabled(false);
+}
@@ -0,0 +1,456 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AnimalBehaviorSystem.h"
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+#include "GameFramework/Pawn.h"
+#include "CameraView.h"
+#include "FyriStats.h"
+#include "DebugOverlay.h"
+#include "DrawDebugHelpers.h"
+
+TMap<TWeakObjectPtr<UWorld>, TWeakObjectPtr<AAnimalBehaviorSystem>> AAnimalBehaviorSystem::sSystems;
+constexpr uint8 AAnimalBehaviorSystem::SignificanceNotApplied;
+
+AAnimalBehaviorSystem::AAnimalBehaviorSystem()
+	: mNextQueuedTraversal(0)
+	, mFlowFieldAcceptanceRadius(50.f)
+	, mTime(0.0)
+	, mFrameBudgetSeconds(0.0005f)
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = true;
+}
+
+AAnimalBehaviorSystem* AAnimalBehaviorSystem::Get(UWorld* world)
+{
+	if (world == nullptr)
+		return nullptr;
+
+	if (AAnimalBehaviorSystem* system = sSystems.FindRef(world).Get())
+		return system;
+
+	FActorSpawnParameters spawnInfo;
+	spawnInfo.ObjectFlags |= RF_Transient;
+
+	AAnimalBehaviorSystem* system = world->SpawnActor<AAnimalBehaviorSystem>(spawnInfo);
+	if (system != nullptr)
+	{
+		sSystems.Add(world, system);
+	}
+
+	return system;
+}
+
+void AAnimalBehaviorSystem::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	sSystems.Remove(GetWorld());
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AAnimalBehaviorSystem::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	AAnimalBehaviorSystem* This = CastChecked<AAnimalBehaviorSystem>(InThis);
+	This->mControllers.AddReferencedObjects(Collector, This);
+
+	Super::AddReferencedObjects(InThis, Collector);
+}
+
+FEntityHandle AAnimalBehaviorSystem::Register(AAnimalController* controller)
+{
+	const FEntityHandle animal = mControllers.Add(controller);
+
+	mStates.Add(EAnimalState::Spawn);
+	mTransitions.Add(EAnimalTransition::SpawnToTraverse);
+	mTraversalCounts.Add(0);
+	mMaxTraversalCounts.Add(controller->GetMaxTraversalCount());
+	mIdleDurations.Add(controller->GetIdleDuration());
+	mFlowFieldTargets.Add(INDEX_NONE);
+	mAppliedSignificances.Add(SignificanceNotApplied);
+	mSerials.Add(0);
+
+	return animal;
+}
+
+void AAnimalBehaviorSystem::Unregister(const FEntityHandle& animal)
+{
+	mControllers.Remove(animal);
+}
+
+void AAnimalBehaviorSystem::Tick(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AnimalBehaviorTick);
+
+	Super::Tick(DeltaSeconds);
+
+	mTime += DeltaSeconds;
+
+	SteerFlowFieldAnimals();
+	UpdateSignificance();
+	ExpireIdleTimers();
+	StartQueuedTraversals();
+	BroadcastNotifications();
+	DrawDebugOverlay();
+	Compact();
+}
+
+void AAnimalBehaviorSystem::SteerFlowFieldAnimals()
+{
+	SCOPE_CYCLE_COUNTER(STAT_FlowFieldSteering);
+
+	const TArray<AAnimalController*>& controllers = mControllers.GetEntities();
+
+	for (int32 index = 0; index < mFlowFieldTargets.Num(); ++index)
+	{
+		if (mFlowFieldTargets[index] == INDEX_NONE || controllers[index] == nullptr)
+			continue;
+
+		APawn* pawn = controllers[index]->GetPawn();
+		if (pawn == nullptr)
+			continue;
+
+		FVector direction;
+		if (mFlowFields.GetSteeringDirection(mFlowFieldTargets[index], pawn->GetActorLocation(), mFlowFieldAcceptanceRadius, direction))
+		{
+			pawn->AddMovementInput(direction);
+		}
+		else
+		{
+			//..Arrived, or the way there was blocked off. Either way the move is over, like a path following result
+			mFlowFieldTargets[index] = INDEX_NONE;
+			OnMoveCompleted(controllers[index]->GetBehaviorHandle());
+		}
+	}
+}
+
+void AAnimalBehaviorSystem::UpdateSignificance()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AnimalSignificance);
+
+	FCameraView cameraView;
+	if (!cameraView.InitFromFirstPlayer(GetWorld(), mSignificanceSettings.mFrustumMarginDegrees))
+		return;
+
+	const float mediumDistanceSquared = FMath::Square(mSignificanceSettings.mMediumDistance);
+	const float lowDistanceSquared = FMath::Square(mSignificanceSettings.mLowDistance);
+
+	const TArray<AAnimalController*>& controllers = mControllers.GetEntities();
+
+	for (int32 index = 0; index < controllers.Num(); ++index)
+	{
+		AAnimalCharacter* character = controllers[index] != nullptr ? Cast<AAnimalCharacter>(controllers[index]->GetPawn()) : nullptr;
+
+		//..Pooled animals are hidden and already don't tick
+		if (character == nullptr || character->bHidden)
+			continue;
+
+		const FVector animalLocation = character->GetActorLocation();
+		const float distanceSquared = cameraView.GetDistanceSquared(animalLocation);
+
+		EAnimalSignificance significance = EAnimalSignificance::High;
+		if (!cameraView.IsInView(animalLocation))
+		{
+			significance = EAnimalSignificance::OffScreen;
+		}
+		else if (distanceSquared > lowDistanceSquared)
+		{
+			significance = EAnimalSignificance::Low;
+		}
+		else if (distanceSquared > mediumDistanceSquared)
+		{
+			significance = EAnimalSignificance::Medium;
+		}
+
+		const bool isIdle = mStates[index] == EAnimalState::Idle;
+		const uint8 appliedSignificance = static_cast<uint8>(significance) | (isIdle ? SignificanceIdleBit : 0);
+
+		if (appliedSignificance != mAppliedSignificances[index])
+		{
+			character->ApplySignificance(significance, isIdle, mSignificanceSettings);
+			mAppliedSignificances[index] = appliedSignificance;
+		}
+	}
+}
+
+bool AAnimalBehaviorSystem::StartFlowFieldTraversal(const FEntityHandle& animal, const ATargetPoint* waypoint)
+{
+	const int32 index = mControllers.GetIndex(animal);
+	if (index == INDEX_NONE)
+		return false;
+
+	APawn* pawn = mControllers.GetEntities()[index]->GetPawn();
+	const int32 fieldIndex = mFlowFields.FindOrBuildField(waypoint);
+
+	if (pawn == nullptr || !mFlowFields.IsReachable(fieldIndex, pawn->GetActorLocation()))
+		return false;
+
+	mFlowFieldTargets[index] = fieldIndex;
+	return true;
+}
+
+void AAnimalBehaviorSystem::ExpireIdleTimers()
+{
+	while (mIdleTimers.Num() > 0 && mIdleTimers.HeapTop().mDeadline <= mTime)
+	{
+		FIdleTimer timer;
+		mIdleTimers.HeapPop(timer, false);
+
+		const int32 index = GetCurrentIndex(timer.mAnimal, timer.mSerial);
+		if (index == INDEX_NONE)
+			continue;
+
+		mTransitions[index] = EAnimalTransition::IdleToTraverse;
+		TraverseAtIndex(index);
+	}
+}
+
+void AAnimalBehaviorSystem::StartQueuedTraversals()
+{
+	SCOPE_CYCLE_COUNTER(STAT_StartAnimalTraversals);
+
+	const double endTime = FPlatformTime::Seconds() + mFrameBudgetSeconds;
+	bool hasStartedAny = false;
+
+	while (mNextQueuedTraversal < mQueuedTraversals.Num())
+	{
+		if (hasStartedAny && FPlatformTime::Seconds() >= endTime)
+			break;
+
+		const FQueuedTraversal& traversal = mQueuedTraversals[mNextQueuedTraversal++];
+
+		const int32 index = GetCurrentIndex(traversal.mAnimal, traversal.mSerial);
+		if (index == INDEX_NONE)
+			continue;
+
+		//..Starting the move can complete it right away, which changes the state and queues more
+		mControllers.GetEntities()[index]->GoToRandomWaypoint();
+		hasStartedAny = true;
+	}
+
+	if (mNextQueuedTraversal >= mQueuedTraversals.Num())
+	{
+		mQueuedTraversals.Reset();
+		mNextQueuedTraversal = 0;
+	}
+}
+
+void AAnimalBehaviorSystem::BroadcastNotifications()
+{
+	//Listeners may change states, which can queue more notifications for next frame
+	TArray<FEntityHandle, TInlineAllocator<8>> exitedAnimals(mExitedAnimals);
+	TArray<FEntityHandle, TInlineAllocator<8>> killedAnimals(mKilledAnimals);
+	mExitedAnimals.Reset();
+	mKilledAnimals.Reset();
+
+	for (const FEntityHandle& animal : exitedAnimals)
+	{
+		if (AAnimalController* controller = mControllers.Get(animal))
+		{
+			OnAnimalExited.Broadcast(controller);
+		}
+	}
+
+	for (const FEntityHandle& animal : killedAnimals)
+	{
+		if (AAnimalController* controller = mControllers.Get(animal))
+		{
+			OnAnimalKilled.Broadcast(controller);
+		}
+	}
+}
+
+void AAnimalBehaviorSystem::DrawDebugOverlay() const
+{
+#if ENABLE_DRAW_DEBUG
+	FDebugOverlay overlay;
+	if (!overlay.Begin(GetWorld(), { EDebugOverlayLayer::Waypoints }))
+		return;
+
+	const TArray<AAnimalController*>& controllers = mControllers.GetEntities();
+
+	for (int32 index = 0; index < controllers.Num(); ++index)
+	{
+		if (controllers[index] == nullptr || mStates[index] != EAnimalState::Traverse)
+			continue;
+
+		const APawn* pawn = controllers[index]->GetPawn();
+		const ATargetPoint* waypoint = controllers[index]->GetCurrentWaypoint();
+
+		if (pawn == nullptr || waypoint == nullptr || !overlay.TryDrawAt(pawn->GetActorLocation()))
+			continue;
+
+		//..Flow field animals in cyan, pathfinding ones in green
+		const FColor color = mFlowFieldTargets[index] != INDEX_NONE ? FColor::Cyan : FColor::Green;
+
+		DrawDebugLine(GetWorld(), pawn->GetActorLocation(), waypoint->GetActorLocation(), color, false, 0.f);
+		DrawDebugSphere(GetWorld(), waypoint->GetActorLocation(), 10.f, 6, color, false, 0.f);
+	}
+#endif
+}
+
+void AAnimalBehaviorSystem::Compact()
+{
+	mControllers.Flush([this](int32 fromIndex, int32 toIndex)
+	{
+		mStates[toIndex] = mStates[fromIndex];
+		mTransitions[toIndex] = mTransitions[fromIndex];
+		mTraversalCounts[toIndex] = mTraversalCounts[fromIndex];
+		mMaxTraversalCounts[toIndex] = mMaxTraversalCounts[fromIndex];
+		mIdleDurations[toIndex] = mIdleDurations[fromIndex];
+		mFlowFieldTargets[toIndex] = mFlowFieldTargets[fromIndex];
+		mAppliedSignificances[toIndex] = mAppliedSignificances[fromIndex];
+		mSerials[toIndex] = mSerials[fromIndex];
+	});
+
+	const int32 numAnimals = mControllers.GetEntities().Num();
+	mStates.SetNum(numAnimals, false);
+	mTransitions.SetNum(numAnimals, false);
+	mTraversalCounts.SetNum(numAnimals, false);
+	mMaxTraversalCounts.SetNum(numAnimals, false);
+	mIdleDurations.SetNum(numAnimals, false);
+	mFlowFieldTargets.SetNum(numAnimals, false);
+	mAppliedSignificances.SetNum(numAnimals, false);
+	mSerials.SetNum(numAnimals, false);
+}
+
+int32 AAnimalBehaviorSystem::GetCurrentIndex(const FEntityHandle& animal, uint32 serial) const
+{
+	const int32 index = mControllers.GetIndex(animal);
+	return index != INDEX_NONE && mSerials[index] == serial ? index : INDEX_NONE;
+}
+
+void AAnimalBehaviorSystem::SetStateAtIndex(int32 index, EAnimalState newState)
+{
+	SCOPE_CYCLE_COUNTER(STAT_AnimalStateTransition);
+
+	mStates[index] = newState;
+	++mSerials[index];
+
+	//A new traversal picks its own target once it starts
+	mFlowFieldTargets[index] = INDEX_NONE;
+}
+
+void AAnimalBehaviorSystem::TraverseAtIndex(int32 index)
+{
+	SetStateAtIndex(index, EAnimalState::Traverse);
+
+	FQueuedTraversal traversal;
+	traversal.mAnimal = mControllers.GetEntities()[index]->GetBehaviorHandle();
+	traversal.mSerial = mSerials[index];
+	mQueuedTraversals.Add(traversal);
+}
+
+void AAnimalBehaviorSystem::IdleAtIndex(int32 index)
+{
+	SetStateAtIndex(index, EAnimalState::Idle);
+
+	if (mTraversalCounts[index] >= mMaxTraversalCounts[index])
+	{
+		mTransitions[index] = EAnimalTransition::IdleToExit;
+		OnExit(mControllers.GetEntities()[index]->GetBehaviorHandle());
+		return;
+	}
+
+	FIdleTimer timer;
+	timer.mDeadline = mTime + mIdleDurations[index];
+	timer.mAnimal = mControllers.GetEntities()[index]->GetBehaviorHandle();
+	timer.mSerial = mSerials[index];
+	mIdleTimers.HeapPush(timer);
+}
+
+void AAnimalBehaviorSystem::OnSpawn(const FEntityHandle& animal)
+{
+	const int32 index = mControllers.GetIndex(animal);
+	if (index == INDEX_NONE)
+		return;
+
+	SetStateAtIndex(index, EAnimalState::Spawn);
+
+	mTransitions[index] = EAnimalTransition::SpawnToTraverse;
+	TraverseAtIndex(index);
+}
+
+void AAnimalBehaviorSystem::OnTraverse(const FEntityHandle& animal)
+{
+	const int32 index = mControllers.GetIndex(animal);
+	if (index != INDEX_NONE)
+	{
+		TraverseAtIndex(index);
+	}
+}
+
+void AAnimalBehaviorSystem::OnIdle(const FEntityHandle& animal)
+{
+	const int32 index = mControllers.GetIndex(animal);
+	if (index != INDEX_NONE)
+	{
+		IdleAtIndex(index);
+	}
+}
+
+void AAnimalBehaviorSystem::OnExit(const FEntityHandle& animal)
+{
+	const int32 index = mControllers.GetIndex(animal);
+	if (index == INDEX_NONE)
+		return;
+
+	SetStateAtIndex(index, EAnimalState::Exit);
+	mExitedAnimals.Add(animal);
+}
+
+void AAnimalBehaviorSystem::OnMoveCompleted(const FEntityHandle& animal)
+{
+	const int32 index = mControllers.GetIndex(animal);
+	if (index == INDEX_NONE || mStates[index] == EAnimalState::Kill)
+		return;
+
+	mTraversalCounts[index]++;
+	mTransitions[index] = EAnimalTransition::TraverseToIdle;
+	IdleAtIndex(index);
+}
+
+void AAnimalBehaviorSystem::SetState(const FEntityHandle& animal, EAnimalState newState)
+{
+	const int32 index = mControllers.GetIndex(animal);
+	if (index == INDEX_NONE)
+		return;
+
+	if (newState == EAnimalState::Idle)
+	{
+		//..Idling has to time out, so go through the same path as arriving at a waypoint
+		IdleAtIndex(index);
+		return;
+	}
+
+	SetStateAtIndex(index, newState);
+
+	if (newState == EAnimalState::Kill)
+	{
+		mKilledAnimals.Add(animal);
+	}
+}
+
+void AAnimalBehaviorSystem::ResetAnimal(const FEntityHandle& animal)
+{
+	const int32 index = mControllers.GetIndex(animal);
+	if (index == INDEX_NONE)
+		return;
+
+	SetStateAtIndex(index, EAnimalState::Spawn);
+	mTransitions[index] = EAnimalTransition::SpawnToTraverse;
+	mTraversalCounts[index] = 0;
+	mAppliedSignificances[index] = SignificanceNotApplied;
+}
+
+EAnimalState AAnimalBehaviorSystem::GetState(const FEntityHandle& animal) const
+{
+	const int32 index = mControllers.GetIndex(animal);
+	return index != INDEX_NONE ? mStates[index] : EAnimalState::Spawn;
+}
+
+EAnimalTransition AAnimalBehaviorSystem::GetTransition(const FEntityHandle& animal) const
+{
+	const int32 index = mControllers.GetIndex(animal);
+	return index != INDEX_NONE ? mTransitions[index] : EAnimalTransition::SpawnToTraverse;
+}
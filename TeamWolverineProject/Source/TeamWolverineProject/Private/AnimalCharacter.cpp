@@ -3,26 +3,69 @@
 
 #include "AnimalCharacter.h"
 #include "AnimalController.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+
+FAnimalSignificanceSettings::FAnimalSignificanceSettings()
+	: mMediumDistance(2000.f)
+	, mLowDistance(5000.f)
+	, mMediumTickInterval(1.f / 30.f)
+	, mLowTickInterval(0.1f)
+	, mOffScreenTickInterval(0.25f)
+	, mFrustumMarginDegrees(10.f)
+{
+}
+
+float FAnimalSignificanceSettings::GetTickInterval(EAnimalSignificance significance) const
+{
+	switch (significance)
+	{
+	case EAnimalSignificance::Medium:
+		return mMediumTickInterval;
+	case EAnimalSignificance::Low:
+		return mLowTickInterval;
+	case EAnimalSignificance::OffScreen:
+		return mOffScreenTickInterval;
+	default:
+		return 0.f;
+	}
+}
 
 // Sets default values
 AAnimalCharacter::AAnimalCharacter()
+	: mSignificance(EAnimalSignificance::High)
+	, mDefaultAnimTickOption(EVisibilityBasedAnimTickOption::AlwaysTickPose)
 {
- 	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	//Nothing to do per frame, movement and animation tick on their own components at a rate set by ApplySignificance.
+	PrimaryActorTick.bCanEverTick = false;
 
+	//Lets the engine skip animation updates based on how much of the screen the mesh covers
+	GetMesh()->bEnableUpdateRateOptimizations = true;
 }
 
 // Called when the game starts or when spawned
 void AAnimalCharacter::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	mDefaultAnimTickOption = GetMesh()->VisibilityBasedAnimTickOption;
 }
 
-// Called every frame
-void AAnimalCharacter::Tick(float DeltaTime)
+void AAnimalCharacter::ApplySignificance(EAnimalSignificance significance, bool isIdle, const FAnimalSignificanceSettings& settings)
 {
-	Super::Tick(DeltaTime);
+	mSignificance = significance;
+
+	const float tickInterval = settings.GetTickInterval(significance);
+
+	UCharacterMovementComponent* movementComponent = GetCharacterMovement();
+	movementComponent->SetComponentTickInterval(tickInterval);
+	movementComponent->SetComponentTickEnabled(!isIdle || significance == EAnimalSignificance::High);
+
+	USkeletalMeshComponent* meshComponent = GetMesh();
+	meshComponent->SetComponentTickInterval(tickInterval);
+
+	//Off screen only montages keep playing, so they still end on time
+	meshComponent->VisibilityBasedAnimTickOption = significance == EAnimalSignificance::OffScreen ? EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered : mDefaultAnimTickOption.GetValue();
 }
 
 // Called to bind functionality to input
@@ -32,3 +75,21 @@ void AAnimalCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputCom
 
 }
 
+
+void AAnimalCharacter::OnAcquiredFromPool()
+{
+	GetCharacterMovement()->SetComponentTickEnabled(true);
+}
+
+void AAnimalCharacter::OnReturnedToPool()
+{
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->SetComponentTickEnabled(false);
+	mEntityHandle = FEntityHandle();
+
+	//The controller stays possessed while pooled, so it's reused along with the character.
+	if (AAnimalController* controller = Cast<AAnimalController>(GetController()))
+	{
+		controller->ResetForReuse();
+	}
+}
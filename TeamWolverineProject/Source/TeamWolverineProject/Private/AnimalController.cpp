@@ -1,100 +1,142 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "AnimalController.h"
-#include "Kismet/GameplayStatics.h"
 #include "GameFramework/Actor.h"
 #include "AnimalCharacter.h"
-#include "DrawDebugHelpers.h"
+#include "AnimalBehaviorSystem.h"
 #include "GameFramework/CharacterMovementComponent.h"
 
-//#define DEBUG_RENDER
+AAnimalController::AAnimalController()
+	: mWaypointRegistry(nullptr)
+	, mWaypointSearchRadius(0.f)
+	, mMaxTraversalCount(0)
+	, mUseFlowFieldNavigation(false)
+	, mIdleDuration(4.f)
+	, mBehaviorSystem(nullptr)
+{
+}
 
 void AAnimalController::BeginPlay()
 {
 	Super::BeginPlay();
 
-	mTraversalCount = 0;
-	mTimeSpentInIdle = 0.f;
+	mWaypointRegistry = AWaypointRegistry::Get(GetWorld());
 
-	UGameplayStatics::GetAllActorsOfClass(this, ATargetPoint::StaticClass(), mWaypoints);
+	mBehaviorSystem = AAnimalBehaviorSystem::Get(GetWorld());
+	if (mBehaviorSystem != nullptr)
+	{
+		mBehaviorHandle = mBehaviorSystem->Register(this);
+	}
 }
 
-void AAnimalController::Tick(float DeltaSeconds)
+void AAnimalController::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaSeconds);
-
-	if (mCurrentState == EAnimalState::Idle)
+	if (mBehaviorSystem != nullptr)
 	{
-		mTimeSpentInIdle += GetWorld()->GetDeltaSeconds();
-
-		if (mTimeSpentInIdle >= 4.f)
-		{
-			mCurrentTransition = EAnimalTransition::IdleToTraverse;
-			OnTraverse();
-			mTimeSpentInIdle = 0.f;
-		}
+		mBehaviorSystem->Unregister(mBehaviorHandle);
+		mBehaviorSystem = nullptr;
 	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
-void AAnimalController::OnSpawn()
+EAnimalState AAnimalController::GetCurrentState() const
 {
-	mCurrentState = EAnimalState::Spawn;
+	return mBehaviorSystem != nullptr ? mBehaviorSystem->GetState(mBehaviorHandle) : EAnimalState::Spawn;
+}
 
-	mCurrentTransition = EAnimalTransition::SpawnToTraverse;
-	OnTraverse();
+EAnimalTransition AAnimalController::GetAnimalTransition() const
+{
+	return mBehaviorSystem != nullptr ? mBehaviorSystem->GetTransition(mBehaviorHandle) : EAnimalTransition::SpawnToTraverse;
 }
 
-void AAnimalController::OnTraverse()
+void AAnimalController::OnSpawn()
 {
-	mCurrentState = EAnimalState::Traverse;
+	if (mBehaviorSystem != nullptr)
+	{
+		mBehaviorSystem->OnSpawn(mBehaviorHandle);
+	}
+}
 
-	GoToRandomWaypoint();
+void AAnimalController::OnTraverse()
+{
+	if (mBehaviorSystem != nullptr)
+	{
+		mBehaviorSystem->OnTraverse(mBehaviorHandle);
+	}
 }
 
 // traversal transition
 void AAnimalController::OnMoveCompleted(FAIRequestID RequestID, const FPathFollowingResult& Result)
 {
-	mTraversalCount++;
-	mCurrentTransition = EAnimalTransition::TraverseToIdle;
-	OnIdle();
+	if (mBehaviorSystem != nullptr)
+	{
+		mBehaviorSystem->OnMoveCompleted(mBehaviorHandle);
+	}
 }
 
 void AAnimalController::SetCurrentState(EAnimalState newState)
 {
-	mCurrentState = newState;
+	if (mBehaviorSystem != nullptr)
+	{
+		mBehaviorSystem->SetState(mBehaviorHandle, newState);
+	}
 }
 
 void AAnimalController::OnIdle()
 {
-	mCurrentState = EAnimalState::Idle;
-
-	if (mTraversalCount >= mMaxTraversalCount)
+	if (mBehaviorSystem != nullptr)
 	{
-		mCurrentTransition = EAnimalTransition::IdleToExit;
-		OnExit();
+		mBehaviorSystem->OnIdle(mBehaviorHandle);
 	}
 }
 
 void AAnimalController::OnExit()
 {
-	mCurrentState = EAnimalState::Exit;
+	if (mBehaviorSystem != nullptr)
+	{
+		mBehaviorSystem->OnExit(mBehaviorHandle);
+	}
+}
+
+void AAnimalController::ResetForReuse()
+{
+	StopMovement();
+	mCurrentWaypoint = nullptr;
+
+	if (mBehaviorSystem != nullptr)
+	{
+		mBehaviorSystem->ResetAnimal(mBehaviorHandle);
+	}
 }
 
 ATargetPoint* AAnimalController::GetRandomWaypoint()
 {
-	if (mWaypoints.Num() > 0)
+	if (mWaypointRegistry == nullptr || mBehaviorSystem == nullptr)
+		return nullptr;
+
+	//Shared by every animal, so the choices replay along with the seed
+	const FRandomStream& randomStream = mBehaviorSystem->GetRandomStream();
+
+	if (mWaypointSearchRadius > 0.f && GetPawn() != nullptr)
 	{
-		auto index = FMath::RandRange(0, mWaypoints.Num() - 1);
-		return Cast<ATargetPoint>(mWaypoints[index]);
+		if (ATargetPoint* nearbyWaypoint = mWaypointRegistry->GetWeightedRandomWaypoint(GetPawn()->GetActorLocation(), mWaypointSearchRadius, randomStream))
+			return nearbyWaypoint;
 	}
 
-	return nullptr;
+	return mWaypointRegistry->GetRandomWaypoint(randomStream);
 }
 
 void AAnimalController::GoToRandomWaypoint()
 {
 	ATargetPoint* wayPoint = GetRandomWaypoint();
-	MoveToActor(wayPoint);
+	mCurrentWaypoint = wayPoint;
+
+	const bool isFollowingFlowField = mUseFlowFieldNavigation && mBehaviorSystem != nullptr && mBehaviorSystem->StartFlowFieldTraversal(mBehaviorHandle, wayPoint);
+	if (!isFollowingFlowField)
+	{
+		MoveToActor(wayPoint);
+	}
 
 	if (AAnimalCharacter* character = Cast<AAnimalCharacter>(GetCharacter()))
 	{
@@ -103,9 +145,4 @@ void AAnimalController::GoToRandomWaypoint()
 			movementComponent->bOrientRotationToMovement = true;
 		}
 	}
-
-#ifdef DEBUG_RENDER
-	DrawDebugString(GetWorld(), wayPoint->GetActorLocation(), "waypoint", NULL, FColor::Green, 20.f);
-	DrawDebugSphere(GetWorld(), wayPoint->GetActorLocation(), 10.f, 6, FColor::Green, false, 20.f);
-#endif
 }
\ No newline at end of file
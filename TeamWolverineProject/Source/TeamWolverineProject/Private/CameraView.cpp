@@ -0,0 +1,22 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CameraView.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+
+bool FCameraView::InitFromFirstPlayer(const UWorld* world, float marginDegrees)
+{
+	const APlayerController* playerController = world != nullptr ? world->GetFirstPlayerController() : nullptr;
+	const APlayerCameraManager* cameraManager = playerController != nullptr ? playerController->PlayerCameraManager : nullptr;
+
+	if (cameraManager == nullptr)
+		return false;
+
+	mLocation = cameraManager->GetCameraLocation();
+	mDirection = cameraManager->GetCameraRotation().Vector();
+
+	const float halfViewAngle = FMath::Min(cameraManager->GetFOVAngle() * 0.5f + marginDegrees, 180.f);
+	mMinViewCosine = FMath::Cos(FMath::DegreesToRadians(halfViewAngle));
+	return true;
+}
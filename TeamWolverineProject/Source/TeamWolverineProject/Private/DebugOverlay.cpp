@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "DebugOverlay.h"
+#include "HAL/IConsoleManager.h"
+
+#if ENABLE_DRAW_DEBUG
+
+static TAutoConsoleVariable<int32> CVarDebugOverlay(
+	TEXT("Fyri.DebugOverlay"),
+	0,
+	TEXT("Debug drawing of gameplay state, add up the layers to show:\n")
+	TEXT(" 1: plantable neighbors and interactions\n")
+	TEXT(" 2: plantable growth\n")
+	TEXT(" 4: animal waypoints"));
+
+static TAutoConsoleVariable<int32> CVarDebugOverlayMaxDraws(
+	TEXT("Fyri.DebugOverlay.MaxDraws"),
+	100,
+	TEXT("Most things the debug overlay draws per frame"));
+
+static TAutoConsoleVariable<float> CVarDebugOverlayMaxDistance(
+	TEXT("Fyri.DebugOverlay.MaxDistance"),
+	3000.f,
+	TEXT("The debug overlay only draws things closer to the camera than this"));
+
+uint64 FDebugOverlay::sBudgetFrame = 0;
+int32 FDebugOverlay::sNumDrawsThisFrame = 0;
+
+bool FDebugOverlay::IsEnabled(EDebugOverlayLayer layer)
+{
+	return (CVarDebugOverlay.GetValueOnGameThread() & static_cast<int32>(layer)) != 0;
+}
+
+bool FDebugOverlay::Begin(const UWorld* world, std::initializer_list<EDebugOverlayLayer> layers)
+{
+	bool isAnyEnabled = false;
+	for (const EDebugOverlayLayer layer : layers)
+	{
+		isAnyEnabled |= IsEnabled(layer);
+	}
+
+	if (!isAnyEnabled || !mCameraView.InitFromFirstPlayer(world, 0.f))
+		return false;
+
+	mMaxDistanceSquared = FMath::Square(CVarDebugOverlayMaxDistance.GetValueOnGameThread());
+
+	if (sBudgetFrame != GFrameCounter)
+	{
+		sBudgetFrame = GFrameCounter;
+		sNumDrawsThisFrame = 0;
+	}
+
+	return true;
+}
+
+bool FDebugOverlay::TryDrawAt(const FVector& location)
+{
+	if (sNumDrawsThisFrame >= CVarDebugOverlayMaxDraws.GetValueOnGameThread())
+		return false;
+
+	if (mCameraView.GetDistanceSquared(location) > mMaxDistanceSquared || !mCameraView.IsInView(location))
+		return false;
+
+	++sNumDrawsThisFrame;
+	return true;
+}
+
+#endif
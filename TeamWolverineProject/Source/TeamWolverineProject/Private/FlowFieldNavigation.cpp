@@ -0,0 +1,235 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FlowFieldNavigation.h"
+#include "TileGrid.h"
+#include "Engine/TargetPoint.h"
+#include "FyriStats.h"
+
+constexpr uint32 FFlowFieldNavigation::Unreachable;
+
+FFlowFieldNavigation::FFlowFieldNavigation()
+{
+}
+
+FFlowFieldNavigation::~FFlowFieldNavigation()
+{
+	SetTileGrid(nullptr);
+}
+
+void FFlowFieldNavigation::SetTileGrid(ATileGrid* tileGrid)
+{
+	if (ATileGrid* oldTileGrid = mTileGrid.Get())
+	{
+		oldTileGrid->OnTraversabilityChanged.Remove(mTraversabilityChangedHandle);
+		oldTileGrid->OnGridRebuilt.Remove(mGridRebuiltHandle);
+	}
+
+	mTileGrid = tileGrid;
+
+	if (tileGrid != nullptr)
+	{
+		mTraversabilityChangedHandle = tileGrid->OnTraversabilityChanged.AddRaw(this, &FFlowFieldNavigation::OnTraversabilityChanged);
+		mGridRebuiltHandle = tileGrid->OnGridRebuilt.AddRaw(this, &FFlowFieldNavigation::OnGridRebuilt);
+	}
+
+	RebuildAll();
+}
+
+int32 FFlowFieldNavigation::FindOrBuildField(const ATargetPoint* waypoint)
+{
+	if (waypoint == nullptr || !mTileGrid.IsValid())
+		return INDEX_NONE;
+
+	if (const int32* fieldIndex = mFieldIndices.Find(waypoint))
+		return *fieldIndex;
+
+	if (mTileGrid->GetTileIndexForLocation(waypoint->GetActorLocation()) == INDEX_NONE)
+		return INDEX_NONE;
+
+	const int32 fieldIndex = mFields.AddDefaulted();
+	FFlowField& field = mFields[fieldIndex];
+	field.mGoalLocation = waypoint->GetActorLocation();
+	Build(field);
+
+	mFieldIndices.Add(waypoint, fieldIndex);
+	return fieldIndex;
+}
+
+void FFlowFieldNavigation::RebuildAll()
+{
+	for (FFlowField& field : mFields)
+	{
+		Build(field);
+	}
+}
+
+void FFlowFieldNavigation::OnGridRebuilt()
+{
+	RebuildAll();
+}
+
+void FFlowFieldNavigation::Build(FFlowField& field) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_FlowFieldBuild);
+
+	const ATileGrid* tileGrid = mTileGrid.Get();
+	const int32 numTiles = tileGrid != nullptr ? tileGrid->Num() : 0;
+
+	field.mDistances.Init(Unreachable, numTiles);
+	field.mNextTiles.Init(INDEX_NONE, numTiles);
+	field.mGoalTile = tileGrid != nullptr ? tileGrid->GetTileIndexForLocation(field.mGoalLocation) : INDEX_NONE;
+
+	if (field.mGoalTile == INDEX_NONE)
+		return;
+
+	field.mDistances[field.mGoalTile] = 0;
+
+	TArray<FFrontierTile> frontier;
+	frontier.HeapPush({ 0, field.mGoalTile });
+	Propagate(field, frontier);
+}
+
+void FFlowFieldNavigation::Propagate(FFlowField& field, TArray<FFrontierTile>& frontier) const
+{
+	const ATileGrid* tileGrid = mTileGrid.Get();
+
+	while (frontier.Num() > 0)
+	{
+		FFrontierTile current;
+		frontier.HeapPop(current, false);
+
+		//..Already reached through a shorter path since it was pushed
+		if (current.mDistance > field.mDistances[current.mTileIndex])
+			continue;
+
+		const uint32 neighborDistance = current.mDistance + 1;
+
+		for (uint8 slot = 0; slot < static_cast<uint8>(ENeighborLocationType::MAX); ++slot)
+		{
+			const int32 neighborIndex = tileGrid->GetNeighborTileIndex(current.mTileIndex, static_cast<ENeighborLocationType>(slot));
+
+			if (neighborIndex == INDEX_NONE || !tileGrid->IsValidTile(neighborIndex) || !tileGrid->IsTraversable(neighborIndex))
+				continue;
+
+			if (neighborDistance < field.mDistances[neighborIndex])
+			{
+				field.mDistances[neighborIndex] = neighborDistance;
+				field.mNextTiles[neighborIndex] = current.mTileIndex;
+				frontier.HeapPush({ neighborDistance, neighborIndex });
+			}
+		}
+	}
+}
+
+void FFlowFieldNavigation::PushReachableNeighbors(const FFlowField& field, int32 tileIndex, TArray<FFrontierTile>& frontier) const
+{
+	const ATileGrid* tileGrid = mTileGrid.Get();
+
+	for (uint8 slot = 0; slot < static_cast<uint8>(ENeighborLocationType::MAX); ++slot)
+	{
+		const int32 neighborIndex = tileGrid->GetNeighborTileIndex(tileIndex, static_cast<ENeighborLocationType>(slot));
+
+		if (neighborIndex != INDEX_NONE && field.mDistances[neighborIndex] != Unreachable)
+		{
+			frontier.HeapPush({ field.mDistances[neighborIndex], neighborIndex });
+		}
+	}
+}
+
+void FFlowFieldNavigation::OnTraversabilityChanged(int32 tileIndex, bool isTraversable)
+{
+	for (FFlowField& field : mFields)
+	{
+		if (isTraversable)
+		{
+			OnTileUnblocked(field, tileIndex);
+		}
+		else
+		{
+			OnTileBlocked(field, tileIndex);
+		}
+	}
+}
+
+void FFlowFieldNavigation::OnTileBlocked(FFlowField& field, int32 tileIndex)
+{
+	//The goal is always reachable from itself, and nothing routes through a tile that couldn't be reached.
+	if (tileIndex == field.mGoalTile || field.mDistances[tileIndex] == Unreachable)
+		return;
+
+	const ATileGrid* tileGrid = mTileGrid.Get();
+
+	//Every tile whose path went through the blocked tile loses its distance...
+	TArray<int32> invalidatedTiles;
+	invalidatedTiles.Add(tileIndex);
+	field.mDistances[tileIndex] = Unreachable;
+	field.mNextTiles[tileIndex] = INDEX_NONE;
+
+	for (int32 invalidated = 0; invalidated < invalidatedTiles.Num(); ++invalidated)
+	{
+		const int32 invalidatedTile = invalidatedTiles[invalidated];
+
+		for (uint8 slot = 0; slot < static_cast<uint8>(ENeighborLocationType::MAX); ++slot)
+		{
+			const int32 neighborIndex = tileGrid->GetNeighborTileIndex(invalidatedTile, static_cast<ENeighborLocationType>(slot));
+
+			if (neighborIndex != INDEX_NONE && field.mNextTiles[neighborIndex] == invalidatedTile)
+			{
+				field.mDistances[neighborIndex] = Unreachable;
+				field.mNextTiles[neighborIndex] = INDEX_NONE;
+				invalidatedTiles.Add(neighborIndex);
+			}
+		}
+	}
+
+	//...and is filled in again from the tiles bordering them that kept theirs.
+	TArray<FFrontierTile> frontier;
+	for (const int32 invalidatedTile : invalidatedTiles)
+	{
+		PushReachableNeighbors(field, invalidatedTile, frontier);
+	}
+
+	Propagate(field, frontier);
+}
+
+void FFlowFieldNavigation::OnTileUnblocked(FFlowField& field, int32 tileIndex)
+{
+	if (field.mGoalTile == INDEX_NONE)
+		return;
+
+	//Only distances can go down, so it's enough to spread out from the tile's reachable neighbors.
+	TArray<FFrontierTile> frontier;
+	PushReachableNeighbors(field, tileIndex, frontier);
+	Propagate(field, frontier);
+}
+
+bool FFlowFieldNavigation::IsReachable(int32 fieldIndex, const FVector& location) const
+{
+	const ATileGrid* tileGrid = mTileGrid.Get();
+	if (tileGrid == nullptr || !mFields.IsValidIndex(fieldIndex))
+		return false;
+
+	const int32 tileIndex = tileGrid->GetTileIndexForLocation(location);
+	return tileIndex != INDEX_NONE && mFields[fieldIndex].mDistances[tileIndex] != Unreachable;
+}
+
+bool FFlowFieldNavigation::GetSteeringDirection(int32 fieldIndex, const FVector& location, float acceptanceRadius, FVector& outDirection) const
+{
+	if (!IsReachable(fieldIndex, location))
+		return false;
+
+	const ATileGrid* tileGrid = mTileGrid.Get();
+	const FFlowField& field = mFields[fieldIndex];
+
+	const int32 tileIndex = tileGrid->GetTileIndexForLocation(location);
+	const int32 nextTile = field.mNextTiles[tileIndex];
+
+	//On the goal tile, head for the waypoint itself
+	const FVector target = nextTile != INDEX_NONE ? tileGrid->GetTileLocation(nextTile) : field.mGoalLocation;
+
+	if (nextTile == INDEX_NONE && FVector::Dist2D(location, target) <= acceptanceRadius)
+		return false;
+
+	outDirection = (target - location).GetSafeNormal2D();
+	return true;
+}
@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FyriStats.h"
+
+DEFINE_STAT(STAT_ObjectManagerTick);
+DEFINE_STAT(STAT_PlantSignificance);
+DEFINE_STAT(STAT_PlantableGrowth);
+DEFINE_STAT(STAT_PlantableGrow);
+DEFINE_STAT(STAT_InteractionEvaluation);
+DEFINE_STAT(STAT_FindNeighbors);
+DEFINE_STAT(STAT_SpawnObject);
+DEFINE_STAT(STAT_SpawnAnimal);
+DEFINE_STAT(STAT_AnimalBehaviorTick);
+DEFINE_STAT(STAT_AnimalStateTransition);
+DEFINE_STAT(STAT_StartAnimalTraversals);
+DEFINE_STAT(STAT_AnimalSignificance);
+DEFINE_STAT(STAT_FlowFieldSteering);
+DEFINE_STAT(STAT_FlowFieldBuild);
+
+DEFINE_STAT(STAT_NumPlantables);
+DEFINE_STAT(STAT_NumAnimals);
+
+DEFINE_STAT(STAT_InteractionsEvaluated);
+DEFINE_STAT(STAT_InteractionsFired);
+DEFINE_STAT(STAT_BlueprintEvents);
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GrowthScheduler.h"
+#include "PlantableObject.h"
+
+FGrowthScheduler::FGrowthScheduler(float tickInterval)
+	: mTime(0.0)
+	, mCurrentTick(0)
+	, mTickInterval(tickInterval)
+{
+}
+
+void FGrowthScheduler::Schedule(APlantableObject* object, float delaySeconds)
+{
+	//Bumping the serial makes any timer the object already has stale, it is dropped when its slot comes up.
+	const uint32 serial = ++object->mGrowthTimerSerial;
+
+	const uint64 delayTicks = FMath::Max<uint64>(1, FMath::CeilToInt(delaySeconds / mTickInterval));
+	const uint64 deadlineTick = mCurrentTick + delayTicks;
+
+	mSlots[deadlineTick % NumSlots].Add({ object, serial, deadlineTick });
+	object->mGrowthDeadline = deadlineTick * static_cast<double>(mTickInterval);
+}
+
+void FGrowthScheduler::Cancel(APlantableObject* object)
+{
+	++object->mGrowthTimerSerial;
+}
+
+void FGrowthScheduler::Advance(float deltaSeconds, TArray<FDueObject>& outDueObjects)
+{
+	mTime += deltaSeconds;
+
+	const uint64 targetTick = static_cast<uint64>(mTime / mTickInterval);
+	if (targetTick <= mCurrentTick)
+		return;
+
+	//..If more than a full revolution passed, every slot only has to be visited once.
+	const uint64 ticksToVisit = FMath::Min<uint64>(targetTick - mCurrentTick, NumSlots);
+
+	for (uint64 tick = mCurrentTick + 1; tick <= mCurrentTick + ticksToVisit; ++tick)
+	{
+		CollectDueTimers(mSlots[tick % NumSlots], targetTick, outDueObjects);
+	}
+
+	mCurrentTick = targetTick;
+}
+
+void FGrowthScheduler::CollectDueTimers(TArray<FTimer>& slot, uint64 dueTick, TArray<FDueObject>& outDueObjects)
+{
+	for (int32 i = slot.Num() - 1; i >= 0; --i)
+	{
+		const FTimer& timer = slot[i];
+
+		if (IsStale(timer))
+		{
+			slot.RemoveAtSwap(i, 1, false);
+		}
+		else if (timer.mDeadlineTick <= dueTick)
+		{
+			outDueObjects.Add({ timer.mObject.Get(), timer.mSerial });
+			slot.RemoveAtSwap(i, 1, false);
+		}
+	}
+}
+
+bool FGrowthScheduler::IsStillDue(const FDueObject& dueObject)
+{
+	return dueObject.mSerial == dueObject.mObject->mGrowthTimerSerial;
+}
+
+bool FGrowthScheduler::IsStale(const FTimer& timer) const
+{
+	const APlantableObject* object = timer.mObject.Get();
+	return object == nullptr || timer.mSerial != object->mGrowthTimerSerial;
+}
@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "InteractionTable.h"
+#include "ObjectManager.h"
+#include "TeamWolverineProject.h"
+
+FInteractionTable::FInteractionTable()
+{
+	Reset();
+}
+
+void FInteractionTable::Reset()
+{
+	for (uint8 objectType = 0; objectType < NumPlantableObjectTypes; ++objectType)
+	{
+		for (uint8 neighborType = 0; neighborType < NumPlantableObjectTypes; ++neighborType)
+		{
+			mPlantableInteractions[objectType][neighborType] = NoInteraction;
+		}
+
+		for (uint8 tileType = 0; tileType < NumTileTypes; ++tileType)
+		{
+			mTerrainInteractions[objectType][tileType] = NoInteraction;
+		}
+	}
+
+	mInteractions.Reset();
+	mInteractionNames.Reset();
+	mInteractionIds.Reset();
+}
+
+void FInteractionTable::Build(const TArray<UObjectInteraction*>& interactions)
+{
+	Reset();
+
+	for (UObjectInteraction* interaction : interactions)
+	{
+		if (interaction == nullptr)
+			continue;
+
+		if (mInteractions.Contains(interaction))
+		{
+			UE_LOG(LogFyri, Warning, TEXT("Interaction %s is listed more than once, ignoring the duplicate."), *interaction->GetName());
+			continue;
+		}
+
+		const int16 interactionId = mInteractions.Num();
+		const uint8 typeA = static_cast<uint8>(interaction->mTypeA);
+
+		bool wasAssigned = false;
+		if (interaction->mObjectType == EObjectType::EPlantable)
+		{
+			//Plantable interactions go both ways, so fill in both orders of the pair.
+			const uint8 typeB = static_cast<uint8>(interaction->mPlantableObjectType);
+
+			wasAssigned = TryAssign(mPlantableInteractions[typeA][typeB], interactionId, *interaction->GetName());
+			if (wasAssigned && typeA != typeB)
+			{
+				mPlantableInteractions[typeB][typeA] = interactionId;
+			}
+		}
+		else if (interaction->mObjectType == EObjectType::ETerrain)
+		{
+			const uint8 tileType = static_cast<uint8>(interaction->mTerrainType);
+
+			wasAssigned = TryAssign(mTerrainInteractions[typeA][tileType], interactionId, *interaction->GetName());
+		}
+
+		if (wasAssigned)
+		{
+			mInteractions.Add(interaction);
+			mInteractionNames.Add(interaction->GetName());
+			mInteractionIds.Add(interaction, interactionId);
+		}
+	}
+}
+
+int16 FInteractionTable::FindInteractionId(const UObjectInteraction* interaction) const
+{
+	const int16* interactionId = mInteractionIds.Find(interaction);
+	return interactionId != nullptr ? *interactionId : NoInteraction;
+}
+
+bool FInteractionTable::TryAssign(int16& entry, int16 interactionId, const TCHAR* interactionName)
+{
+	//The first interaction listed for a pair wins, which is what the old linear scan did as well.
+	if (entry != NoInteraction)
+	{
+		UE_LOG(LogFyri, Warning, TEXT("Interaction %s uses the same pair of types as %s and will never be triggered."), interactionName, *mInteractions[entry]->GetName());
+		return false;
+	}
+
+	entry = interactionId;
+	return true;
+}
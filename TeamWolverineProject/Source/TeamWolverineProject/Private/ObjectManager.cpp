@@ -1,10 +1,12 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "ObjectManager.h"
+#include "TeamWolverineProject.h"
 #include "Engine\Classes\Components\InputComponent.h"
 #include "Engine/World.h"
-#include "Tile.h"
+#include "TileGrid.h"
 #include "Components/ActorComponent.h"
+#include "Components/StaticMeshComponent.h"
 #include "GameFramework/PlayerController.h"
 #include "Kismet/GameplayStatics.h"
 #include "UObjectIterator.h"
@@ -16,10 +18,31 @@
 #include "GameFramework/Actor.h"
 #include "AnimalController.h"
 #include "AnimalCharacter.h"
+#include "AnimalBehaviorSystem.h"
+#include "CameraView.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/MemStack.h"
+#include "FyriStats.h"
+#include "DebugOverlay.h"
+
+#if !UE_BUILD_SHIPPING
+static FAutoConsoleCommandWithWorldAndArgs GAdvanceTimeCommand(
+	TEXT("Fyri.AdvanceTime"),
+	TEXT("Grows every plantable as if the given number of seconds had passed. Fyri.AdvanceTime <seconds> [coalesce grow events, 1 by default]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& args, UWorld* world)
+	{
+		if (args.Num() == 0 || world == nullptr)
+			return;
 
-#define BIG_FLOAT 99999999999.f
+		const float seconds = FCString::Atof(*args[0]);
+		const bool coalesceGrowEvents = args.Num() < 2 || FCString::Atoi(*args[1]) != 0;
 
-//#define DEBUG_RENDER
+		for (TActorIterator<AObjectManagerComponent> it(world); it; ++it)
+		{
+			it->AdvanceTime(seconds, coalesceGrowEvents);
+		}
+	}));
+#endif
 
 FSpawnTierProbabilities::FSpawnTierProbabilities()
 	: mCommonProbability(90)
@@ -28,8 +51,65 @@ FSpawnTierProbabilities::FSpawnTierProbabilities()
 {
 }
 
+const FSpawnTierProbabilities& FGameSpawnProbabilities::GetProbabilities(EPlantableObjectType objectType) const
+{
+	switch (objectType)
+	{
+	case EPlantableObjectType::Tree:
+		return mTreeProbabilities;
+	case EPlantableObjectType::Food:
+		return mEdibleProbabilities;
+	default:
+		return mPlantProbabilities;
+	}
+}
+
+const TArray<TSubclassOf<APlantableObject>>& UPlantableInventory::GetTierInventory(ESpawnTier tier) const
+{
+	switch (tier)
+	{
+	case ESpawnTier::Fancy:
+		return mFancyObjectInventory;
+	case ESpawnTier::Mythical:
+		return mMythicalObjectInventory;
+	default:
+		return mCommonObjectInventory;
+	}
+}
+
+const UPlantableInventory* UGameObjectInventory::GetInventory(EPlantableObjectType objectType) const
+{
+	switch (objectType)
+	{
+	case EPlantableObjectType::Plant:
+		return mPlantInventory;
+	case EPlantableObjectType::Tree:
+		return mTreeInventory;
+	case EPlantableObjectType::Food:
+		return mEdibleInventory;
+	default:
+		return nullptr;
+	}
+}
+
 AObjectManagerComponent::AObjectManagerComponent()
-	: mCurrentlySelectedPlantableObject(EPlantableObjectType::Plant)
+	: mRandomSeed(0)
+	, mUseInstancedPlantables(false)
+	, mPlantableInstancer(nullptr)
+	, mPrewarmedAnimalsPerClass(2)
+	, mPrewarmedPlantablesPerClass(0)
+	, mMaxAnimalSpawnsPerFrame(1)
+	, mActorPool(nullptr)
+	, mAnimalSpawnsThisFrame(0)
+	, mAnimalBehaviorBudgetMs(0.5f)
+	, mAnimalBehaviorSystem(nullptr)
+	, mNextPlantSignificanceIndex(0)
+	, mTileGrid(nullptr)
+	, mTimeUntilDormantEvaluation(0.f)
+	, mCurrentlySelectedPlantableObject(EPlantableObjectType::Plant)
+	, mIsHoverPreviewEnabled(false)
+	, mHoverTileIndex(INDEX_NONE)
+	, mCanSpawnAtHoverTile(false)
 {
 	PrimaryActorTick.bCanEverTick = true;
 	PrimaryActorTick.bStartWithTickEnabled = true;
@@ -39,391 +119,676 @@ AObjectManagerComponent::~AObjectManagerComponent()
 {
 }
 
+void AObjectManagerComponent::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	AObjectManagerComponent* This = CastChecked<AObjectManagerComponent>(InThis);
+	This->mObjects.AddReferencedObjects(Collector, This);
+	This->mAnimals.AddReferencedObjects(Collector, This);
+
+	//..So entries left behind for a destroyed object are nulled rather than dangling
+	Collector.AddReferencedObjects(This->mDirtyObjects, This);
+	Collector.AddReferencedObjects(This->mDormantDirtyObjects, This);
+
+	Super::AddReferencedObjects(InThis, Collector);
+}
+
 void AObjectManagerComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
-	for (UObjectInteraction* interaction : mObjectInteractions)
+	mInteractionTable.Build(mObjectInteractions);
+
+	mInteractionAmounts.Init(0, mInteractionTable.Num());
+
+	for (uint8 objectType = 0; objectType < static_cast<uint8>(EPlantableObjectType::MAX); ++objectType)
 	{
-		if (interaction != nullptr)
+		BuildSpawnTierSampler(static_cast<EPlantableObjectType>(objectType));
+	}
+
+	if (mUseInstancedPlantables)
+	{
+		mPlantableInstancer = NewObject<UPlantableInstancer>(this, TEXT("PlantableInstancer"));
+
+		if (RootComponent != nullptr)
+		{
+			mPlantableInstancer->SetupAttachment(RootComponent);
+		}
+		else
 		{
-			const FString interactionName = interaction->GetName();
-			mPlantedAmounts.Add(interactionName);
+			SetRootComponent(mPlantableInstancer);
 		}
+
+		mPlantableInstancer->RegisterComponent();
+	}
+
+	mAnimalBehaviorSystem = AAnimalBehaviorSystem::Get(GetWorld());
+	InitRandomStreams();
+
+	mHoverTraceDelegate.BindUObject(this, &AObjectManagerComponent::OnHoverTraceDone);
+
+	if (mAnimalBehaviorSystem != nullptr)
+	{
+		mAnimalBehaviorSystem->SetFrameBudget(mAnimalBehaviorBudgetMs / 1000.f);
+		mAnimalBehaviorSystem->SetSignificanceSettings(mAnimalSignificanceSettings);
+		mAnimalBehaviorSystem->OnAnimalExited.AddUObject(this, &AObjectManagerComponent::HandleAnimalExited);
+		mAnimalBehaviorSystem->OnAnimalKilled.AddUObject(this, &AObjectManagerComponent::HandleAnimalKilled);
 	}
+
+	mActorPool = NewObject<UActorPool>(this, TEXT("ActorPool"));
+	PrewarmActorPool();
 }
 
-void AObjectManagerComponent::Init(TArray<ATile*> tiles)
+void AObjectManagerComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	mTiles = tiles;
+	if (mAnimalBehaviorSystem != nullptr)
+	{
+		mAnimalBehaviorSystem->OnAnimalExited.RemoveAll(this);
+		mAnimalBehaviorSystem->OnAnimalKilled.RemoveAll(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
-void AObjectManagerComponent::Tick(float DeltaSeconds)
+void AObjectManagerComponent::HandleAnimalExited(AAnimalController* controller)
 {
-	for (AAnimalCharacter* animal : mAnimals)
+	if (AAnimalCharacter* animal = Cast<AAnimalCharacter>(controller->GetPawn()))
 	{
-		if (!mDiscoveredTypes.Contains(animal->mIndex))
+		if (mAnimals.IsValid(animal->GetEntityHandle()))
 		{
-			OnDiscoveredObject();
-			mDiscoveredTypes.Add(animal->mIndex);
+			INC_DWORD_STAT(STAT_BlueprintEvents);
+			OnAnimalExited(animal);
 		}
+	}
+}
 
-		AAnimalController* controller = Cast<AAnimalController>(animal->GetController());
-		if (controller != nullptr && controller->GetCurrentState() == EAnimalState::Kill)
-		{
-			mAnimals.Remove(animal);
-			animal->Destroy();
-		}
+void AObjectManagerComponent::HandleAnimalKilled(AAnimalController* controller)
+{
+	AAnimalCharacter* animal = Cast<AAnimalCharacter>(controller->GetPawn());
+	if (animal == nullptr || !mAnimals.IsValid(animal->GetEntityHandle()))
+		return;
+
+	mAnimals.Remove(animal->GetEntityHandle());
+	mActorPool->Release(animal);
+}
+
+void AObjectManagerComponent::PrewarmActorPool()
+{
+	TSet<UClass*> animalClasses;
+	for (const TSubclassOf<AAnimalCharacter>& animalClass : mAnimalInventory)
+	{
+		animalClasses.Add(animalClass);
 	}
 
-	for (APlantableObject* object : mObjects)
+	//Animals spawned by interaction results are the ones that come in bursts
+	for (const UObjectInteraction* interaction : mObjectInteractions)
 	{
-#ifdef DEBUG_RENDER //TODO.PKH: make this changeable in runtime instead!
-		DebugRenderObject(object);
-#endif
+		if (interaction == nullptr)
+			continue;
 
-		if (!mDiscoveredTypes.Contains(object->mIndex) && object->mCurrentGrowingStage > EGrowingStage::Sprout)
+		if (interaction->mInteractionResult != nullptr)
 		{
-			OnDiscoveredObject();
-			mDiscoveredTypes.Add(object->mIndex);
+			animalClasses.Add(interaction->mInteractionResult->mAnimal);
 		}
 
-		for (UObjectInteraction* interaction : mObjectInteractions)
+		if (interaction->mRequiredAmountReachedResult != nullptr)
 		{
-			if (interaction == nullptr)
-				continue;
+			animalClasses.Add(interaction->mRequiredAmountReachedResult->mAnimal);
+		}
+	}
 
-			bool succeededToInteract = false;
-			if (interaction->mObjectType == EObjectType::EPlantable)
-			{
-				//If interaction is object + object
-
-				for (const TPair<ENeighborLocationType, APlantableObject*>& neighbor : object->GetNeighbors())
-				{
-					if (!object->HasInteractedWithNeighborBefore(neighbor.Key))
-					{
-						//TODO.PKH: should location be object or neighbor, or in between the two?
-
-						const bool isObjectInteraction = ((object->GetObjectType() == interaction->mTypeA && neighbor.Value->GetObjectType() == interaction->mPlantableObjectType) || object->GetObjectType() == interaction->mPlantableObjectType && neighbor.Value->GetObjectType() == interaction->mTypeA);
-						if (isObjectInteraction)
-						{
-							succeededToInteract = true;
-
-							object->OnInteractWithNeighbor(neighbor.Key);
-							neighbor.Value->OnInteractWithNeighbor(APlantableObject::GetOppositeLocationType(neighbor.Key));
-						}
-					}
-				}
-			}
-			else if (interaction->mObjectType == EObjectType::ETerrain && !object->HasInteractedWithCurrentTileBefore())
-			{
-				//If interaction is object + terrain
+	for (UClass* animalClass : animalClasses)
+	{
+		mActorPool->Prewarm(animalClass, mPrewarmedAnimalsPerClass);
+	}
 
-				const ETileType tileType = object->GetTileTypeForCurrentTile();
+	if (mObjectInventory == nullptr || mPrewarmedPlantablesPerClass <= 0)
+		return;
 
-				const bool isObjectInteraction = ((object->GetObjectType() == interaction->mTypeA && tileType == interaction->mTerrainType));
-				if (isObjectInteraction)
-				{
-					succeededToInteract = true;
+	for (const UPlantableInventory* inventory : { mObjectInventory->mPlantInventory, mObjectInventory->mTreeInventory, mObjectInventory->mEdibleInventory })
+	{
+		if (inventory == nullptr)
+			continue;
 
-					object->OnInteractWithTile();
-				}
-			}
-				
-			const FString interactionName = interaction->GetName();
-			if (succeededToInteract)
+		for (const TArray<TSubclassOf<APlantableObject>>* tierInventory : { &inventory->mCommonObjectInventory, &inventory->mFancyObjectInventory, &inventory->mMythicalObjectInventory })
+		{
+			for (const TSubclassOf<APlantableObject>& objectClass : *tierInventory)
 			{
-				if (mPlantedAmounts.Contains(interactionName))
-				{
-					++mPlantedAmounts[interactionName].mCurrentAmountPlanted;
-				}
-
-				if (HasReachedRequiredInteractionAmount(interaction, object->mCurrentGrowingStage))
-				{
-					OnInteractionReachedRequiredAmount(interaction->mRequiredAmountReachedResult, object->GetActorLocation(), interactionName);
-
-					if (interaction->mShouldRestartAfterReachedRequired)
-					{
-						mPlantedAmounts[interactionName].mCurrentAmountPlanted = 0;
-					}
-				}
-				else
-				{
-					OnInteractionStart(interaction->mInteractionResult, object->GetActorLocation(), interactionName);
-				}
+				mActorPool->Prewarm(objectClass, mPrewarmedPlantablesPerClass);
 			}
 		}
 	}
 }
 
-void AObjectManagerComponent::UpdateCurrentlySelectedPlantableObject(EPlantableObjectType objectType)
+void AObjectManagerComponent::Init(TArray<ATile*> tiles)
 {
-	mCurrentlySelectedPlantableObject = objectType;
+	//..Init again rebuilds the grid it already has
+	ATileGrid* tileGrid = mTileGrid != nullptr ? mTileGrid : GetWorld()->SpawnActor<ATileGrid>();
+	if (tileGrid == nullptr)
+		return;
+
+	tileGrid->BuildFromTileActors(tiles);
+	InitWithTileGrid(tileGrid);
 }
 
-void AObjectManagerComponent::ChangeSpawnProbability(FSpawnTierProbabilities newSpawnProbabilities)
+void AObjectManagerComponent::InitWithTileGrid(ATileGrid* tileGrid)
 {
-	if (newSpawnProbabilities.mObjectType == EPlantableObjectType::Food)
+	mTileGrid = tileGrid;
+
+	mObjectGrid.Reset();
+	mObjectGrid.SetNumZeroed(mTileGrid != nullptr ? mTileGrid->Num() : 0);
+
+	//Animals following flow fields steer over the same grid
+	if (AAnimalBehaviorSystem* animalBehaviorSystem = AAnimalBehaviorSystem::Get(GetWorld()))
 	{
-		mSpawnProbabilities.mEdibleProbabilities.mCommonProbability = newSpawnProbabilities.mCommonProbability;
-		mSpawnProbabilities.mEdibleProbabilities.mFancyProbability = newSpawnProbabilities.mFancyProbability;
-		mSpawnProbabilities.mEdibleProbabilities.mMythicalProbability = newSpawnProbabilities.mMythicalProbability;
+		animalBehaviorSystem->SetTileGrid(mTileGrid);
 	}
-	else if (newSpawnProbabilities.mObjectType == EPlantableObjectType::Plant)
+
+	if (mTileGrid == nullptr)
+		return;
+
+	TArray<APlantableObject*> objectsOffGrid;
+
+	for (APlantableObject* object : mObjects.GetEntities())
 	{
-		mSpawnProbabilities.mPlantProbabilities.mCommonProbability = newSpawnProbabilities.mCommonProbability;
-		mSpawnProbabilities.mPlantProbabilities.mFancyProbability = newSpawnProbabilities.mFancyProbability;
-		mSpawnProbabilities.mPlantProbabilities.mMythicalProbability = newSpawnProbabilities.mMythicalProbability;
+		if (object == nullptr)
+			continue;
+
+		const int32 tileIndex = mTileGrid->GetTileIndexForLocation(object->GetActorLocation());
+		if (!mTileGrid->IsValidTile(tileIndex) || mObjectGrid[tileIndex] != nullptr)
+		{
+			object->SetCurrentTile(mTileGrid, INDEX_NONE);
+			objectsOffGrid.Add(object);
+			continue;
+		}
+
+		mObjectGrid[tileIndex] = object;
+		object->SetCurrentTile(mTileGrid, tileIndex);
+		mTileGrid->OnObjectSpawnOnTile(tileIndex);
 	}
-	else if (newSpawnProbabilities.mObjectType == EPlantableObjectType::Tree)
+
+	//..No tile of their own on the new grid, so they can't stay
+	for (APlantableObject* object : objectsOffGrid)
 	{
-		mSpawnProbabilities.mTreeProbabilities.mCommonProbability = newSpawnProbabilities.mCommonProbability;
-		mSpawnProbabilities.mTreeProbabilities.mFancyProbability = newSpawnProbabilities.mFancyProbability;
-		mSpawnProbabilities.mTreeProbabilities.mMythicalProbability = newSpawnProbabilities.mMythicalProbability;
+		UE_LOG(LogFyri, Warning, TEXT("%s has no free tile on the new tile grid, removing it."), *object->GetName());
+		RemoveObject(object);
+	}
+
+	//Neighbors from the old grid may not be neighbors on this one
+	for (APlantableObject* object : mObjects.GetEntities())
+	{
+		if (object == nullptr)
+			continue;
+
+		const FPlantableNeighbors neighbors = FindNeighborsForObject(object->GetCurrentTile());
+		for (uint8 slot = 0; slot < FPlantableNeighbors::NumSlots; ++slot)
+		{
+			const ENeighborLocationType locationType = static_cast<ENeighborLocationType>(slot);
+			object->SetNeighbor(neighbors.Get(locationType), locationType);
+		}
 	}
 }
 
-bool AObjectManagerComponent::HasReachedRequiredInteractionAmount(UObjectInteraction* interaction, EGrowingStage mCurrentObjectsGrowingStage) const
+void AObjectManagerComponent::Tick(float DeltaSeconds)
 {
-	if (!ensureMsgf(interaction != nullptr, TEXT("Interaction sent in to HasReachedRequiredInteractionAmount was nullptr!")))
-		return false;
+	SCOPE_CYCLE_COUNTER(STAT_ObjectManagerTick);
+
+	//Temporaries of this tick come off the memory stack, and are all freed when it returns
+	FMemMark frameMark(FMemStack::Get());
+
+	mAnimalSpawnsThisFrame = 0;
+	SpawnPendingAnimals();
 
-	const FString interactionName = interaction->GetName();
+	//Before growing, so plantables put to sleep this frame don't grow
+	UpdatePlantSignificance();
 
-	if (mPlantedAmounts.Contains(interactionName))
 	{
-		//Only want to trigger it the first time (hence == instead of >= )
-		
-		const bool reachedRequiredAmount = mPlantedAmounts[interactionName].mCurrentAmountPlanted == interaction->mRequiredAmount;
-		const bool hasARequiredAmount = interaction->mRequiredAmount > 0;
+		SCOPE_CYCLE_COUNTER(STAT_PlantableGrowth);
 
-		const bool returnVal = hasARequiredAmount && reachedRequiredAmount;
+		mGrowthScheduler.Advance(DeltaSeconds, mObjectsToGrow);
 
-		if (returnVal)
+		for (const FGrowthScheduler::FDueObject& dueObject : mObjectsToGrow)
 		{
-			return true;
+			//..Removed or put to sleep by an earlier object's grow event
+			if (!FGrowthScheduler::IsStillDue(dueObject))
+				continue;
+
+			APlantableObject* object = dueObject.mObject;
+			object->Grow();
+			ScheduleGrowth(object);
 		}
 
-		return false;
+		mObjectsToGrow.Reset();
 	}
 
-	return false;
-}
+	UpdateHoverPreview();
+	DrawDebugOverlay();
 
-const TMap<ENeighborLocationType, APlantableObject*> AObjectManagerComponent::FindNeighborsForObject(APlantableObject* spawnedObject) const
-{
-	TMap<ENeighborLocationType, TTuple<APlantableObject*, float>> potentialNeighbors;
+	//Only objects whose neighbors, tile or growing stage changed can have a new interaction,
+	//anything queued while evaluating (e.g. spawns from BP events) is picked up next frame.
+	Swap(mDirtyObjects, mObjectsBeingEvaluated);
 
-	//Find potential neighbors
-	for (APlantableObject* objectToCheckWith : mObjects)
+	mTimeUntilDormantEvaluation -= DeltaSeconds;
+	if (mTimeUntilDormantEvaluation <= 0.f)
 	{
-		if (spawnedObject == objectToCheckWith)
-			continue;
+		mObjectsBeingEvaluated.Append(mDormantDirtyObjects);
+		mDormantDirtyObjects.Reset();
+		mTimeUntilDormantEvaluation = mPlantSignificanceSettings.mDormantEvaluationInterval;
+	}
 
-		const float distance = FVector::Distance(spawnedObject->GetActorLocation(), objectToCheckWith->GetActorLocation());
-		const FVector direction = spawnedObject->GetActorLocation() - objectToCheckWith->GetActorLocation();
+	{
+		SCOPE_CYCLE_COUNTER(STAT_InteractionEvaluation);
+
+		for (APlantableObject* object : mObjectsBeingEvaluated)
+		{
+			//..Removed since it was queued, or already evaluated from another entry
+			if (object == nullptr || !object->IsQueuedForInteractionUpdate())
+				continue;
 
-		GatherObjectIfIsNeighbor(potentialNeighbors, objectToCheckWith, direction, distance);
+			object->ClearQueuedForInteractionUpdate();
+			EvaluateInteractionsForObject(object);
+		}
+
+		mObjectsBeingEvaluated.Reset();
 	}
 
-	const TMap<ENeighborLocationType, APlantableObject*>& spawnedObjectsNeighbors = spawnedObject->GetNeighbors();
-	TMap<ENeighborLocationType, APlantableObject*> neighbors;
+	//Compact what was removed this frame now that nothing is iterating over them
+	mObjects.Flush();
+	mAnimals.Flush();
+
+	SET_DWORD_STAT(STAT_NumPlantables, mObjects.Num());
+	SET_DWORD_STAT(STAT_NumAnimals, mAnimals.Num());
 
-	//Check which potential neighbors should become neighbors.
-	for (TPair<ENeighborLocationType, TTuple<APlantableObject*, float>>& potentialNeighborData : potentialNeighbors)
+	if (mPlantableInstancer != nullptr)
 	{
-		const ENeighborLocationType closeObjectLocationType = potentialNeighborData.Key;
-		APlantableObject* closeObject = potentialNeighborData.Value.Key;
-		
-		if (spawnedObjectsNeighbors.Contains(closeObjectLocationType))
-		{
-			//..If has neighbor at same location type, check that this one is closer.
-			if (const APlantableObject* const currentObjectToTheLeft = spawnedObjectsNeighbors.FindRef(ENeighborLocationType::Right))
-			{
-				const float distanceToCurrentLeftObject = FVector::Distance(spawnedObject->GetActorLocation(), currentObjectToTheLeft->GetActorLocation());
-				const float distanceToCloseObject = potentialNeighborData.Value.Value;
+		mPlantableInstancer->FlushRenderState();
+	}
+}
 
-				if (distanceToCloseObject < distanceToCurrentLeftObject)
-				{
-					neighbors.Add(closeObjectLocationType, closeObject);
-				}
-			}
+void AObjectManagerComponent::QueueInteractionUpdate(APlantableObject* object)
+{
+	if (object != nullptr && object->MarkQueuedForInteractionUpdate())
+	{
+		if (object->IsDormant())
+		{
+			mDormantDirtyObjects.Add(object);
 		}
 		else
 		{
-			//..If a neighbor at this location type doesn't exist, just add it.
-			neighbors.Add(closeObjectLocationType, closeObject);
+			mDirtyObjects.Add(object);
 		}
 	}
+}
 
-	return neighbors;
+void AObjectManagerComponent::ScheduleGrowth(APlantableObject* object)
+{
+	if (object->CanGrow())
+	{
+		mGrowthScheduler.Schedule(object, object->GetTimeUntilNextGrowingStage());
+	}
 }
 
-void AObjectManagerComponent::GatherObjectIfIsNeighbor(TMap<ENeighborLocationType, TTuple<APlantableObject*, float>>& objects, APlantableObject* objectToCheckWith, const FVector& objectsDirection, const float distanceToObject) const
+void AObjectManagerComponent::UpdatePlantSignificance()
 {
-	const ENeighborLocationType INVALID_LOCATIONTYPE = static_cast<ENeighborLocationType>(-1);
-	ENeighborLocationType closestLocationType = INVALID_LOCATIONTYPE;
-	float biggestDotResult = -BIG_FLOAT;
+	SCOPE_CYCLE_COUNTER(STAT_PlantSignificance);
 
-	for (const ENeighborLocationType& locationType : { ENeighborLocationType::Left, ENeighborLocationType::Right, ENeighborLocationType::Up, ENeighborLocationType::Down })
-	{
-		const FVector targetDirection = GetDirectionFromLocationType(locationType);
-		const float dotResult = FVector::DotProduct(objectsDirection, targetDirection);
+	const TArray<APlantableObject*>& objects = mObjects.GetEntities();
+	if (!mPlantSignificanceSettings.mIsEnabled || objects.Num() == 0)
+		return;
+
+	//..No camera (e.g. a dedicated server), everything stays awake
+	FCameraView cameraView;
+	if (!cameraView.InitFromFirstPlayer(GetWorld(), mPlantSignificanceSettings.mFrustumMarginDegrees))
+		return;
+
+	const float dormantDistanceSquared = FMath::Square(mPlantSignificanceSettings.mDormantDistance);
+	const int32 numToUpdate = FMath::Min(objects.Num(), mPlantSignificanceSettings.mUpdatesPerFrame);
 
-		if (dotResult > 0.f && dotResult > biggestDotResult)
+	for (int32 update = 0; update < numToUpdate; ++update)
+	{
+		if (mNextPlantSignificanceIndex >= objects.Num())
 		{
-			closestLocationType = locationType;
-			biggestDotResult = dotResult;
+			mNextPlantSignificanceIndex = 0;
 		}
-	}
 
-	if (closestLocationType != INVALID_LOCATIONTYPE)
-	{
-		const float tileSize = 260.f; //TODO.PKH: calculate this instead
-		if (objects.Contains(closestLocationType))
+		APlantableObject* object = objects[mNextPlantSignificanceIndex++];
+		if (object == nullptr)
+			continue;
+
+		const FVector location = object->GetActorLocation();
+		const bool shouldBeDormant = !cameraView.IsInView(location) || cameraView.GetDistanceSquared(location) > dormantDistanceSquared;
+
+		if (shouldBeDormant && !object->IsDormant())
 		{
-			const TTuple<APlantableObject*, float> oldLeft = objects.FindRef(closestLocationType);
-			if (distanceToObject < oldLeft.Value)
-			{
-				objects[closestLocationType] = MakeTuple(objectToCheckWith, distanceToObject);
-			}
+			PutToSleep(object);
 		}
-		else if (distanceToObject < tileSize)
+		else if (!shouldBeDormant && object->IsDormant())
 		{
-			objects.Add(closestLocationType, MakeTuple(objectToCheckWith, distanceToObject));
+			WakeUp(object);
 		}
 	}
 }
 
-void AObjectManagerComponent::DebugRenderObject(APlantableObject* objectToRender) const
+void AObjectManagerComponent::PutToSleep(APlantableObject* object)
+{
+	//Its growth deadline is kept, so it can catch up on the stages it missed when it wakes
+	object->SetDormant(true);
+	mGrowthScheduler.Cancel(object);
+}
+
+void AObjectManagerComponent::WakeUp(APlantableObject* object)
 {
-	if (GEngine)
+	object->SetDormant(false);
+
+	//..Its entry in mDormantDirtyObjects is skipped once it has been evaluated
+	if (object->IsQueuedForInteractionUpdate())
 	{
-		const TMap<ENeighborLocationType, APlantableObject*> neighbors = objectToRender->GetNeighbors();
+		mDirtyObjects.Add(object);
+	}
 
-		FString upText = "Up: -\n";
-		FString downText = "Down: -\n";
-		FString leftText = "Left: -\n";
-		FString rightText = "Right: -\n";
+	object->AdvanceGrowth(mGrowthScheduler.GetTime(), 0.0, true);
+	RescheduleGrowth(object);
+}
+
+void AObjectManagerComponent::RescheduleGrowth(APlantableObject* object)
+{
+	//Dormant objects pick up from their deadline when they wake
+	if (object->CanGrow() && !object->IsDormant())
+	{
+		mGrowthScheduler.Schedule(object, static_cast<float>(FMath::Max(object->GetGrowthDeadline() - mGrowthScheduler.GetTime(), 0.0)));
+	}
+}
 
-		FColor colorToUse = FColor::Red;
+void AObjectManagerComponent::AdvanceTime(float seconds, bool coalesceGrowEvents)
+{
+	if (seconds <= 0.f)
+		return;
 
-		if (neighbors.Contains(ENeighborLocationType::Up))
-		{
-			upText = "Up: " + neighbors[ENeighborLocationType::Up]->GetName() + "\n";
-			colorToUse = FColor::Green;
-		}
-		if (neighbors.Contains(ENeighborLocationType::Down))
-		{
-			downText = "Down: " + neighbors[ENeighborLocationType::Down]->GetName() + "\n";
-			colorToUse = FColor::Green;
-		}
-		if (neighbors.Contains(ENeighborLocationType::Left))
-		{
-			leftText = "Left: " + neighbors[ENeighborLocationType::Left]->GetName() + "\n";
-			colorToUse = FColor::Green;
-		}
-		if (neighbors.Contains(ENeighborLocationType::Right))
+	//Grow events can remove objects, which only nulls their entry until the Flush,
+	//and objects they spawn are added past the end, those are only just planted so are left alone.
+	const TArray<APlantableObject*>& objects = mObjects.GetEntities();
+	const int32 numObjects = objects.Num();
+	for (int32 objectIndex = 0; objectIndex < numObjects; ++objectIndex)
+	{
+		if (objects[objectIndex] != nullptr)
 		{
-			rightText = "Right: " + neighbors[ENeighborLocationType::Right]->GetName() + "\n";
-			colorToUse = FColor::Green;
+			AdvanceObjectTime(objects[objectIndex], seconds, coalesceGrowEvents);
 		}
-
-		const FString neighborText = "Neighbors:\n" + upText + downText + leftText + rightText;
-		DrawDebugString(GetWorld(), objectToRender->GetActorLocation() + (FVector::UpVector * 5.f), neighborText, NULL, colorToUse);
 	}
 }
 
-FVector AObjectManagerComponent::GetDirectionFromLocationType(ENeighborLocationType locationType) const
+void AObjectManagerComponent::AdvanceObjectTime(APlantableObject* object, float seconds, bool coalesceGrowEvents)
 {
-	if (locationType == ENeighborLocationType::Right)
-		return FVector::LeftVector;
-	else if (locationType == ENeighborLocationType::Left)
-		return -FVector::LeftVector;
-	else if (locationType == ENeighborLocationType::Up)
-		return -FVector::ForwardVector;
-	else //if (originalType == ENeighborLocationType::Down)
-		return FVector::ForwardVector;
+	if (object == nullptr || !mObjects.IsValid(object->GetEntityHandle()) || !object->CanGrow())
+		return;
+
+	object->AdvanceGrowth(mGrowthScheduler.GetTime(), seconds, coalesceGrowEvents);
+
+	//..A grow event may have removed it
+	if (mObjects.IsValid(object->GetEntityHandle()))
+	{
+		RescheduleGrowth(object);
+	}
 }
 
-TSubclassOf<APlantableObject> AObjectManagerComponent::GetObjectClassToSpawn() const
+void AObjectManagerComponent::EvaluateInteractionsForObject(APlantableObject* object)
 {
-	UPlantableInventory* invCategory = nullptr;
-	switch (mCurrentlySelectedPlantableObject)
+	INC_DWORD_STAT(STAT_InteractionsEvaluated);
+
+	if (!mDiscoveredTypes.Contains(object->GetJournalIndex()) && object->mCurrentGrowingStage > EGrowingStage::Sprout)
 	{
-	case EPlantableObjectType::Plant:
-		invCategory = mObjectInventory->mPlantInventory;
-		break;
-	case EPlantableObjectType::Tree:
-		invCategory = mObjectInventory->mTreeInventory;
-		break;
-	case EPlantableObjectType::Food:
-		invCategory = mObjectInventory->mEdibleInventory;
-		break;
+		INC_DWORD_STAT(STAT_BlueprintEvents);
+		OnDiscoveredObject();
+		mDiscoveredTypes.Add(object->GetJournalIndex());
 	}
 
-	FSpawnTierProbabilities probability;
-	switch (mCurrentlySelectedPlantableObject)
+	const EPlantableObjectType objectType = object->GetObjectType();
+
+	//Each interaction only counts once per evaluation, even if several neighbors trigger it.
+	TArray<int16, TInlineAllocator<FPlantableNeighbors::NumSlots + 1>> succeededInteractions;
+
+	const FPlantableNeighbors& neighbors = object->GetNeighbors();
+	for (uint8 slot = 0; slot < FPlantableNeighbors::NumSlots; ++slot)
 	{
-	case EPlantableObjectType::Plant:
-		probability = mSpawnProbabilities.mPlantProbabilities;
-		break;
-	case EPlantableObjectType::Tree:
-		probability = mSpawnProbabilities.mTreeProbabilities;
-		break;
-	case EPlantableObjectType::Food:
-		probability = mSpawnProbabilities.mEdibleProbabilities;
-		break;
+		const ENeighborLocationType locationType = static_cast<ENeighborLocationType>(slot);
+		APlantableObject* neighbor = neighbors.Get(locationType);
+
+		if (neighbor == nullptr || neighbors.HasInteractedWith(locationType))
+			continue;
+
+		//If interaction is object + object
+		//TODO.PKH: should location be object or neighbor, or in between the two?
+
+		const int16 interactionId = mInteractionTable.GetPlantableInteraction(objectType, neighbor->GetObjectType());
+		if (interactionId != FInteractionTable::NoInteraction)
+		{
+			object->OnInteractWithNeighbor(locationType);
+			neighbor->OnInteractWithNeighbor(APlantableObject::GetOppositeLocationType(locationType));
+
+			succeededInteractions.AddUnique(interactionId);
+		}
+	}
+
+	if (!object->HasInteractedWithCurrentTileBefore())
+	{
+		//If interaction is object + terrain
+
+		const int16 interactionId = mInteractionTable.GetTerrainInteraction(objectType, object->GetTileTypeForCurrentTile());
+		if (interactionId != FInteractionTable::NoInteraction)
+		{
+			object->OnInteractWithTile();
+
+			succeededInteractions.AddUnique(interactionId);
+		}
 	}
 
-	ESpawnTier tier = ESpawnTier::Common;
+	//Fire in the order the interactions were listed in
+	succeededInteractions.Sort();
 
-	const float randVal = FMath::RandRange(0.f, 100.f);
-	if (randVal <= probability.mCommonProbability)
+	for (const int16 interactionId : succeededInteractions)
 	{
-		tier = ESpawnTier::Common;
+		OnInteractionSucceeded(interactionId, object);
 	}
-	else if (randVal >= (100.f - probability.mMythicalProbability))
+}
+
+void AObjectManagerComponent::OnInteractionSucceeded(int16 interactionId, APlantableObject* object)
+{
+	UObjectInteraction* interaction = mInteractionTable.GetInteraction(interactionId);
+	const FString& interactionName = mInteractionTable.GetInteractionName(interactionId);
+
+	INC_DWORD_STAT(STAT_InteractionsFired);
+	INC_DWORD_STAT(STAT_BlueprintEvents);
+
+	++mInteractionAmounts[interactionId];
+
+	if (HasReachedRequiredInteractionAmount(interactionId))
 	{
-		if (invCategory != nullptr)
+		OnInteractionReachedRequiredAmount(interaction->mRequiredAmountReachedResult, object->GetActorLocation(), interactionName);
+
+		if (interaction->mShouldRestartAfterReachedRequired)
 		{
-			tier = ESpawnTier::Mythical;
+			mInteractionAmounts[interactionId] = 0;
 		}
 	}
 	else
 	{
-		if (invCategory != nullptr)
+		OnInteractionStart(interaction->mInteractionResult, object->GetActorLocation(), interactionName);
+	}
+}
+
+void AObjectManagerComponent::UpdateCurrentlySelectedPlantableObject(EPlantableObjectType objectType)
+{
+	mCurrentlySelectedPlantableObject = objectType;
+}
+
+void AObjectManagerComponent::ChangeSpawnProbability(FSpawnTierProbabilities newSpawnProbabilities)
+{
+	if (newSpawnProbabilities.mObjectType == EPlantableObjectType::Food)
+	{
+		mSpawnProbabilities.mEdibleProbabilities.mCommonProbability = newSpawnProbabilities.mCommonProbability;
+		mSpawnProbabilities.mEdibleProbabilities.mFancyProbability = newSpawnProbabilities.mFancyProbability;
+		mSpawnProbabilities.mEdibleProbabilities.mMythicalProbability = newSpawnProbabilities.mMythicalProbability;
+	}
+	else if (newSpawnProbabilities.mObjectType == EPlantableObjectType::Plant)
+	{
+		mSpawnProbabilities.mPlantProbabilities.mCommonProbability = newSpawnProbabilities.mCommonProbability;
+		mSpawnProbabilities.mPlantProbabilities.mFancyProbability = newSpawnProbabilities.mFancyProbability;
+		mSpawnProbabilities.mPlantProbabilities.mMythicalProbability = newSpawnProbabilities.mMythicalProbability;
+	}
+	else if (newSpawnProbabilities.mObjectType == EPlantableObjectType::Tree)
+	{
+		mSpawnProbabilities.mTreeProbabilities.mCommonProbability = newSpawnProbabilities.mCommonProbability;
+		mSpawnProbabilities.mTreeProbabilities.mFancyProbability = newSpawnProbabilities.mFancyProbability;
+		mSpawnProbabilities.mTreeProbabilities.mMythicalProbability = newSpawnProbabilities.mMythicalProbability;
+	}
+	else
+	{
+		return;
+	}
+
+	BuildSpawnTierSampler(newSpawnProbabilities.mObjectType);
+}
+
+bool AObjectManagerComponent::HasReachedRequiredInteractionAmount(UObjectInteraction* interaction, EGrowingStage mCurrentObjectsGrowingStage) const
+{
+	if (!ensureMsgf(interaction != nullptr, TEXT("Interaction sent in to HasReachedRequiredInteractionAmount was nullptr!")))
+		return false;
+
+	const int16 interactionId = mInteractionTable.FindInteractionId(interaction);
+	if (interactionId == FInteractionTable::NoInteraction)
+		return false;
+
+	return HasReachedRequiredInteractionAmount(interactionId);
+}
+
+bool AObjectManagerComponent::HasReachedRequiredInteractionAmount(int16 interactionId) const
+{
+	const UObjectInteraction* interaction = mInteractionTable.GetInteraction(interactionId);
+
+	//Only want to trigger it the first time (hence == instead of >= )
+
+	const bool reachedRequiredAmount = mInteractionAmounts[interactionId] == interaction->mRequiredAmount;
+	const bool hasARequiredAmount = interaction->mRequiredAmount > 0;
+
+	return hasARequiredAmount && reachedRequiredAmount;
+}
+
+int32 AObjectManagerComponent::GetInteractionAmount(UObjectInteraction* interaction) const
+{
+	const int16 interactionId = mInteractionTable.FindInteractionId(interaction);
+	if (interactionId == FInteractionTable::NoInteraction)
+		return 0;
+
+	return mInteractionAmounts[interactionId];
+}
+
+FPlantableNeighbors AObjectManagerComponent::FindNeighborsForObject(int32 tileIndex) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_FindNeighbors);
+
+	FPlantableNeighbors neighbors;
+
+	for (uint8 slot = 0; slot < FPlantableNeighbors::NumSlots; ++slot)
+	{
+		const ENeighborLocationType locationType = static_cast<ENeighborLocationType>(slot);
+		const int32 neighborIndex = mTileGrid->GetNeighborTileIndex(tileIndex, locationType);
+
+		if (neighborIndex != INDEX_NONE)
 		{
-			tier = ESpawnTier::Fancy;
+			neighbors.Set(locationType, mObjectGrid[neighborIndex]);
 		}
 	}
 
-	TArray<TSubclassOf<APlantableObject>> inventory;
-	if (invCategory != nullptr)
+	return neighbors;
+}
+
+void AObjectManagerComponent::DrawDebugOverlay() const
+{
+#if ENABLE_DRAW_DEBUG
+	FDebugOverlay overlay;
+	if (!overlay.Begin(GetWorld(), { EDebugOverlayLayer::Neighbors, EDebugOverlayLayer::Growth }))
+		return;
+
+	const bool isDrawingNeighbors = FDebugOverlay::IsEnabled(EDebugOverlayLayer::Neighbors);
+	const bool isDrawingGrowth = FDebugOverlay::IsEnabled(EDebugOverlayLayer::Growth);
+	const UEnum* growingStageEnum = StaticEnum<EGrowingStage>();
+
+	for (const APlantableObject* object : mObjects.GetEntities())
 	{
-		switch (tier)
+		if (object == nullptr || !overlay.TryDrawAt(object->GetActorLocation()))
+			continue;
+
+		const FVector labelLocation = object->GetActorLocation() + (FVector::UpVector * 5.f);
+
+		if (isDrawingNeighbors)
+		{
+			const FPlantableNeighbors& neighbors = object->GetNeighbors();
+			const bool hasAnyNeighbor = neighbors.mSlots[0] != nullptr || neighbors.mSlots[1] != nullptr || neighbors.mSlots[2] != nullptr || neighbors.mSlots[3] != nullptr;
+
+			DrawDebugString(GetWorld(), labelLocation, object->GetDebugLabel(), nullptr, hasAnyNeighbor ? FColor::Green : FColor::Red, 0.f);
+		}
+
+		if (isDrawingGrowth)
 		{
-		case ESpawnTier::Common:
-			inventory = invCategory->mCommonObjectInventory;
-			break;
-		case ESpawnTier::Fancy:
-			inventory = invCategory->mFancyObjectInventory;
-			break;
-		case ESpawnTier::Mythical:
-			inventory = invCategory->mMythicalObjectInventory;
-			break;
+			FString growthLabel = growingStageEnum->GetNameStringByValue(static_cast<int64>(object->mCurrentGrowingStage));
+			if (object->IsDormant())
+			{
+				growthLabel += TEXT(" (dormant)");
+			}
+			else if (object->CanGrow())
+			{
+				growthLabel += FString::Printf(TEXT(" %.1fs"), object->GetGrowthDeadline() - mGrowthScheduler.GetTime());
+			}
+
+			DrawDebugString(GetWorld(), labelLocation - (FVector::UpVector * 20.f), growthLabel, nullptr, FColor::Yellow, 0.f);
 		}
 	}
+#endif
+}
 
-	if (inventory.Num() > 0)
+TSubclassOf<APlantableObject> AObjectManagerComponent::GetObjectClassToSpawn() const
+{
+	const UPlantableInventory* inventory = mObjectInventory != nullptr ? mObjectInventory->GetInventory(mCurrentlySelectedPlantableObject) : nullptr;
+	if (inventory == nullptr)
+		return nullptr;
+
+	const ESpawnTier tier = mSpawnTierSamplers[static_cast<uint8>(mCurrentlySelectedPlantableObject)].Sample(mSpawnRandomStream.GetFraction());
+	const TArray<TSubclassOf<APlantableObject>>& tierInventory = inventory->GetTierInventory(tier);
+
+	if (tierInventory.Num() > 0)
 	{
-		const float itemIndex = FMath::RandRange(0, inventory.Num() - 1);
-		return inventory[itemIndex];
+		return tierInventory[mSpawnRandomStream.RandRange(0, tierInventory.Num() - 1)];
 	}
 
 	return nullptr;
 }
 
+void AObjectManagerComponent::InitRandomStreams()
+{
+	int32 seed = mRandomSeed;
+	FParse::Value(FCommandLine::Get(), TEXT("FyriSeed="), seed);
+
+	if (seed == 0)
+	{
+		seed = static_cast<int32>(FPlatformTime::Cycles());
+	}
+
+	UE_LOG(LogFyri, Log, TEXT("Random seed %d, pass -FyriSeed=%d to replay this session."), seed, seed);
+
+	mSpawnRandomStream.Initialize(seed);
+	mPlacementRandomStream.Initialize(static_cast<int32>(HashCombine(seed, 1)));
+
+	if (mAnimalBehaviorSystem != nullptr)
+	{
+		mAnimalBehaviorSystem->SetRandomSeed(static_cast<int32>(HashCombine(seed, 2)));
+	}
+}
+
+void AObjectManagerComponent::BuildSpawnTierSampler(EPlantableObjectType objectType)
+{
+	const FSpawnTierProbabilities& probabilities = mSpawnProbabilities.GetProbabilities(objectType);
+	mSpawnTierSamplers[static_cast<uint8>(objectType)].Build(probabilities.mCommonProbability, probabilities.mFancyProbability, probabilities.mMythicalProbability);
+}
+
 void AObjectManagerComponent::SpawnObject()
 {
 	TSubclassOf<APlantableObject> objectToSpawn = GetObjectClassToSpawn();
@@ -431,102 +796,343 @@ void AObjectManagerComponent::SpawnObject()
 	if (objectToSpawn == nullptr)
 		return;
 
+	if (mTileGrid == nullptr)
+		return;
+
+	//..The tile the player is being shown, no need to trace again
+	if (mIsHoverPreviewEnabled)
+	{
+		SpawnObjectAtTile(objectToSpawn, mHoverTileIndex);
+
+		//..So the ghost shows the tile as taken right away, not when the next trace comes back
+		SetHoverTile(mHoverTileIndex);
+		return;
+	}
+
+	APlayerController* playerController = GetWorld()->GetFirstPlayerController();
+	if (playerController == nullptr)
+		return;
+
 	FHitResult hitResult;
-	GetWorld()->GetFirstPlayerController()->GetHitResultUnderCursor(ECollisionChannel::ECC_WorldStatic, false, hitResult);
+	playerController->GetHitResultUnderCursor(ECollisionChannel::ECC_WorldStatic, false, hitResult);
 
 	if (hitResult.GetActor() != nullptr)
 	{
-		ATile* closestTile = nullptr;
-		float closestDistance = BIG_FLOAT;
+		SpawnObjectAtTile(objectToSpawn, mTileGrid->GetTileIndexForLocation(hitResult.Location));
+	}
+}
+
+void AObjectManagerComponent::SetHoverPreviewEnabled(bool isEnabled)
+{
+	if (mIsHoverPreviewEnabled == isEnabled)
+		return;
+
+	mIsHoverPreviewEnabled = isEnabled;
+
+	if (!isEnabled)
+	{
+		//A trace still in flight is ignored when it comes back
+		mHoverTraceHandle = FTraceHandle();
+		SetHoverTile(INDEX_NONE);
+	}
+}
+
+void AObjectManagerComponent::UpdateHoverPreview()
+{
+	//One trace in flight at a time, they come back the frame after they're issued
+	if (!mIsHoverPreviewEnabled || mTileGrid == nullptr || mHoverTraceHandle.IsValid())
+		return;
+
+	APlayerController* playerController = GetWorld()->GetFirstPlayerController();
+	if (playerController == nullptr)
+		return;
+
+	FVector traceStart;
+	FVector traceDirection;
+	if (!playerController->DeprojectMousePositionToWorld(traceStart, traceDirection))
+	{
+		SetHoverTile(INDEX_NONE);
+		return;
+	}
+
+	//Same trace as GetHitResultUnderCursor
+	const FVector traceEnd = traceStart + traceDirection * playerController->HitResultTraceDistance;
+	const FCollisionQueryParams queryParams(SCENE_QUERY_STAT(HoverTileTrace), false);
+
+	mHoverTraceHandle = GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, traceStart, traceEnd, ECollisionChannel::ECC_WorldStatic, queryParams, FCollisionResponseParams::DefaultResponseParam, &mHoverTraceDelegate);
+}
+
+void AObjectManagerComponent::OnHoverTraceDone(const FTraceHandle& traceHandle, FTraceDatum& traceDatum)
+{
+	if (traceHandle != mHoverTraceHandle)
+		return;
+
+	mHoverTraceHandle = FTraceHandle();
+
+	const FHitResult* hitResult = traceDatum.OutHits.Num() > 0 ? &traceDatum.OutHits[0] : nullptr;
+	const bool hasHit = hitResult != nullptr && hitResult->bBlockingHit && mTileGrid != nullptr;
+
+	SetHoverTile(hasHit ? mTileGrid->GetTileIndexForLocation(hitResult->Location) : INDEX_NONE);
+}
+
+void AObjectManagerComponent::SetHoverTile(int32 tileIndex)
+{
+	if (mTileGrid == nullptr || !mTileGrid->IsValidTile(tileIndex))
+	{
+		tileIndex = INDEX_NONE;
+	}
+
+	const bool canSpawn = tileIndex != INDEX_NONE && mTileGrid->IsFree(tileIndex);
+
+	if (tileIndex == mHoverTileIndex && canSpawn == mCanSpawnAtHoverTile)
+		return;
+
+	mHoverTileIndex = tileIndex;
+	mCanSpawnAtHoverTile = canSpawn;
+
+	const FVector tileLocation = tileIndex != INDEX_NONE ? mTileGrid->GetTileLocation(tileIndex) : FVector::ZeroVector;
+
+	INC_DWORD_STAT(STAT_BlueprintEvents);
+	OnHoverTileChanged(tileIndex != INDEX_NONE, tileLocation, canSpawn);
+}
+
+APlantableObject* AObjectManagerComponent::SpawnObjectAtTile(TSubclassOf<APlantableObject> objectClass, int32 tileIndex)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SpawnObject);
+
+	APlantableObject* spawnedObject = PlaceObjectAtTile(objectClass, tileIndex);
+	if (spawnedObject == nullptr)
+		return nullptr;
+
+	//Find Neighbors for newly spawned object
+	const FPlantableNeighbors newNeighbors = FindNeighborsForObject(tileIndex);
+
+	//Also add the the newly spawned object as a neighbour to its neighbor
+	for (uint8 slot = 0; slot < FPlantableNeighbors::NumSlots; ++slot)
+	{
+		const ENeighborLocationType locationType = static_cast<ENeighborLocationType>(slot);
+		if (APlantableObject* neighbor = newNeighbors.Get(locationType))
+		{
+			neighbor->SetNeighbor(spawnedObject, APlantableObject::GetOppositeLocationType(locationType));
+		}
+	}
+
+	spawnedObject->OnSpawn(this, mTileGrid, tileIndex, newNeighbors);
+	QueueInteractionUpdate(spawnedObject);
+	ScheduleGrowth(spawnedObject);
+
+	INC_DWORD_STAT(STAT_BlueprintEvents);
+	OnObjectSpawned(spawnedObject);
+
+	return spawnedObject;
+}
+
+TArray<APlantableObject*> AObjectManagerComponent::SpawnObjectsAtTiles(const TArray<int32>& tileIndices)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SpawnObject);
+
+	TArray<APlantableObject*> spawnedObjects;
+
+	if (mTileGrid == nullptr)
+		return spawnedObjects;
+
+	FMemMark memMark(FMemStack::Get());
+
+	TArray<int32, TMemStackAllocator<>> spawnedTiles;
+	spawnedTiles.Reserve(tileIndices.Num());
+	spawnedObjects.Reserve(tileIndices.Num());
+
+	//Place every object before linking any, so two objects of the batch are linked once rather than
+	//once from each side. A tile is marked used when placed, so a tile listed twice gets one object.
+	for (const int32 tileIndex : tileIndices)
+	{
+		if (!mTileGrid->IsFree(tileIndex))
+			continue;
+
+		if (APlantableObject* spawnedObject = PlaceObjectAtTile(GetObjectClassToSpawn(), tileIndex))
+		{
+			spawnedObjects.Add(spawnedObject);
+			spawnedTiles.Add(tileIndex);
+		}
+	}
+
+	TArray<FPlantableNeighbors, TMemStackAllocator<>> spawnedNeighbors;
+	spawnedNeighbors.Reserve(spawnedObjects.Num());
+
+	//Objects of the batch find each other themselves, only objects that were already there are told.
+	//Those are the ones on their tile already, the batch hasn't had OnSpawn yet so its objects have no tile.
+	for (int32 index = 0; index < spawnedObjects.Num(); ++index)
+	{
+		const int32 tileIndex = spawnedTiles[index];
+		const FPlantableNeighbors newNeighbors = FindNeighborsForObject(tileIndex);
+		spawnedNeighbors.Add(newNeighbors);
 
-		//Find closest tile
-		for (ATile* tile : mTiles)
+		for (uint8 slot = 0; slot < FPlantableNeighbors::NumSlots; ++slot)
 		{
-			const FVector actorLocation = tile->GetActorLocation();
-			const float distance = FVector::Distance(actorLocation, hitResult.Location);
+			const ENeighborLocationType locationType = static_cast<ENeighborLocationType>(slot);
+			APlantableObject* neighbor = newNeighbors.Get(locationType);
 
-			if (distance < closestDistance)
+			if (neighbor != nullptr && neighbor->GetCurrentTile() != INDEX_NONE)
 			{
-				closestDistance = distance;
-				closestTile = tile;
+				neighbor->SetNeighbor(spawnedObjects[index], APlantableObject::GetOppositeLocationType(locationType));
 			}
 		}
+	}
 
-		if (closestTile != nullptr)
-		{
-			const bool isTraversable = closestTile->IsTraversable();
-			const bool isUsed = closestTile->IsUsed();
+	for (int32 index = 0; index < spawnedObjects.Num(); ++index)
+	{
+		APlantableObject* spawnedObject = spawnedObjects[index];
+		spawnedObject->OnSpawn(this, mTileGrid, spawnedTiles[index], spawnedNeighbors[index]);
 
-			if (!isTraversable || isUsed)
-				return;
+		//..Evaluated once next tick, with all of the batch in place
+		QueueInteractionUpdate(spawnedObject);
+		ScheduleGrowth(spawnedObject);
+	}
 
-			FActorSpawnParameters spawnInfo;
+	if (spawnedObjects.Num() > 0)
+	{
+		INC_DWORD_STAT(STAT_BlueprintEvents);
+		OnObjectsSpawned(spawnedObjects);
+	}
 
-			//Spawn new object
-			const FRotator randomRotation(0.f, FMath::RandRange(0.f, 360.f), 0.f);
+	return spawnedObjects;
+}
 
-			if (APlantableObject* spawnedObject = GetWorld()->SpawnActor<APlantableObject>(objectToSpawn, closestTile->GetActorLocation(), randomRotation, spawnInfo))
-			{
-				mObjects.Add(spawnedObject);
+TArray<APlantableObject*> AObjectManagerComponent::SpawnObjectsInArea(const FVector& center, float radius)
+{
+	TArray<int32> tileIndices;
 
-				if (UMeshComponent* meshComponent = spawnedObject->FindComponentByClass<UMeshComponent>())
-				{
-					const float randomScaleValue = FMath::RandRange(0.8f, 1.2f);
-					const FVector randomScale(randomScaleValue, randomScaleValue, randomScaleValue);
+	if (mTileGrid != nullptr)
+	{
+		mTileGrid->GetTilesInRadius(center, radius, tileIndices);
+	}
 
-					meshComponent->SetWorldScale3D(randomScale);
-				}
+	return SpawnObjectsAtTiles(tileIndices);
+}
 
-				//Find Neighbors for newly spawned object
-				const TMap<ENeighborLocationType, APlantableObject*> newNeighbors = FindNeighborsForObject(spawnedObject);
+APlantableObject* AObjectManagerComponent::PlaceObjectAtTile(TSubclassOf<APlantableObject> objectClass, int32 tileIndex)
+{
+	if (objectClass == nullptr || mTileGrid == nullptr || !mTileGrid->IsFree(tileIndex))
+		return nullptr;
 
-				//Also add the the newly spawned object as a neighbour to its neighbor
-				for (const TPair<ENeighborLocationType, APlantableObject*>& neighbor : newNeighbors)
-				{
-					neighbor.Value->SetNeighbor(spawnedObject, APlantableObject::GetOppositeLocationType(neighbor.Key));
-				}
+	//Spawn new object
+	const FRotator randomRotation(0.f, mPlacementRandomStream.FRandRange(0.f, 360.f), 0.f);
+	const FTransform spawnTransform(randomRotation, mTileGrid->GetTileLocation(tileIndex));
 
-				spawnedObject->OnSpawn(closestTile, newNeighbors);
+	APlantableObject* spawnedObject = mActorPool->Acquire<APlantableObject>(objectClass, spawnTransform);
+	if (spawnedObject == nullptr)
+		return nullptr;
 
-				OnObjectSpawned(spawnedObject);
-				closestTile->OnObjectSpawnOnTile();
-			}
+	spawnedObject->SetEntityHandle(mObjects.Add(spawnedObject));
+	mObjectGrid[tileIndex] = spawnedObject;
+	mTileGrid->OnObjectSpawnOnTile(tileIndex);
+
+	if (UMeshComponent* meshComponent = spawnedObject->GetMeshComponent())
+	{
+		const float randomScaleValue = mPlacementRandomStream.FRandRange(0.8f, 1.2f);
+		const FVector randomScale(randomScaleValue, randomScaleValue, randomScaleValue);
+
+		meshComponent->SetWorldScale3D(randomScale);
+	}
+
+	if (mPlantableInstancer != nullptr)
+	{
+		spawnedObject->EnableInstancedRendering(mPlantableInstancer);
+	}
+
+	return spawnedObject;
+}
+
+void AObjectManagerComponent::RemoveObject(APlantableObject* object)
+{
+	if (object == nullptr || !mObjects.IsValid(object->GetEntityHandle()))
+		return;
+
+	const int32 tileIndex = object->GetCurrentTile();
+	if (mObjectGrid.IsValidIndex(tileIndex))
+	{
+		mObjectGrid[tileIndex] = nullptr;
+		mTileGrid->OnObjectRemovedFromTile(tileIndex);
+	}
+
+	const FPlantableNeighbors& neighbors = object->GetNeighbors();
+	for (uint8 slot = 0; slot < FPlantableNeighbors::NumSlots; ++slot)
+	{
+		const ENeighborLocationType locationType = static_cast<ENeighborLocationType>(slot);
+		if (APlantableObject* neighbor = neighbors.Get(locationType))
+		{
+			neighbor->SetNeighbor(nullptr, APlantableObject::GetOppositeLocationType(locationType));
 		}
 	}
+
+	//Entries it still has in the dirty and grow lists are left, and skipped where they're consumed:
+	//cancelling makes its growth stale, and returning it to the pool clears its queued flag.
+	mGrowthScheduler.Cancel(object);
+	mObjects.Remove(object->GetEntityHandle());
+
+	mActorPool->Release(object);
 }
 
 void AObjectManagerComponent::SpawnAnimal(TSubclassOf<AAnimalCharacter> animal)
 {
-	TSubclassOf<AAnimalCharacter> objectToSpawn = animal;
+	if (animal == nullptr)
+		return;
 
-	if (objectToSpawn == nullptr)
+	//Keep the order animals were requested in, so only spawn right away if nothing is waiting
+	if (mPendingAnimalSpawns.Num() > 0 || mAnimalSpawnsThisFrame >= mMaxAnimalSpawnsPerFrame)
+	{
+		mPendingAnimalSpawns.Add(animal);
+		return;
+	}
+
+	SpawnAnimalNow(animal);
+}
+
+void AObjectManagerComponent::SpawnPendingAnimals()
+{
+	const int32 numToSpawn = FMath::Min(mPendingAnimalSpawns.Num(), mMaxAnimalSpawnsPerFrame - mAnimalSpawnsThisFrame);
+	if (numToSpawn <= 0)
 		return;
 
-	TArray<ATile*> availableTiles;
-	for (ATile* tile : mTiles)
+	for (int32 pendingIndex = 0; pendingIndex < numToSpawn; ++pendingIndex)
 	{
-		if (tile->IsTraversable())
-		{
-			availableTiles.Add(tile);
-		}
+		SpawnAnimalNow(mPendingAnimalSpawns[pendingIndex]);
 	}
 
-	const uint8 tileIndex = FMath::RandRange(0, mTiles.Num() - 1);
-	if (!availableTiles.IsValidIndex(tileIndex))
+	mPendingAnimalSpawns.RemoveAt(0, numToSpawn, false);
+}
+
+void AObjectManagerComponent::SpawnAnimalNow(TSubclassOf<AAnimalCharacter> animal)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SpawnAnimal);
+
+	TSubclassOf<AAnimalCharacter> objectToSpawn = animal;
+	++mAnimalSpawnsThisFrame;
+
+	if (objectToSpawn == nullptr || mTileGrid == nullptr)
 		return;
 
-	ATile* spawnTile = availableTiles[tileIndex];
+	const int32 spawnTile = mTileGrid->GetRandomTraversableTile(mPlacementRandomStream);
+	if (spawnTile == INDEX_NONE)
+		return;
 
-	FActorSpawnParameters spawnInfo;
-	if (AAnimalCharacter* spawnedObject = GetWorld()->SpawnActor<AAnimalCharacter>(objectToSpawn, spawnTile->GetActorLocation(), { 0.0f, 0.0f, 0.0f }, spawnInfo))
+	if (AAnimalCharacter* spawnedObject = mActorPool->Acquire<AAnimalCharacter>(objectToSpawn, FTransform(mTileGrid->GetTileLocation(spawnTile))))
 	{
 		AAnimalController* controller = Cast<AAnimalController>(spawnedObject->GetController());
 
 		if (controller != nullptr)
 		{
 			controller->OnSpawn();
-			mAnimals.Add(spawnedObject);
+			spawnedObject->SetEntityHandle(mAnimals.Add(spawnedObject));
+			INC_DWORD_STAT(STAT_BlueprintEvents);
 			OnAnimalSpawned(spawnedObject);
+
+			if (!mDiscoveredTypes.Contains(spawnedObject->mIndex))
+			{
+				INC_DWORD_STAT(STAT_BlueprintEvents);
+				OnDiscoveredObject();
+				mDiscoveredTypes.Add(spawnedObject->mIndex);
+			}
 		}
 	}
 }
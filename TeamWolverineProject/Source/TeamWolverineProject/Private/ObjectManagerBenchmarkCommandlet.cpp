@@ -0,0 +1,246 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ObjectManagerBenchmarkCommandlet.h"
+#include "TeamWolverineProject.h"
+#include "ObjectManager.h"
+#include "TileGrid.h"
+#include "PlantableObject.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/PlatformMemory.h"
+
+//Process wide and only as fine as the allocator asks the OS for memory, so small allocations served from memory
+//the allocator already has don't show. Still enough to tell whether a function keeps growing memory once warmed up.
+static int64 GetUsedPhysicalMemory()
+{
+	return static_cast<int64>(FPlatformMemory::GetStats().UsedPhysical);
+}
+
+template<typename ResultType, typename FuncType>
+static void Measure(ResultType& result, FuncType func)
+{
+	const int64 memoryBefore = GetUsedPhysicalMemory();
+	const double startTime = FPlatformTime::Seconds();
+
+	func();
+
+	const double elapsedSeconds = FPlatformTime::Seconds() - startTime;
+	result.mMemoryGrowthBytes += GetUsedPhysicalMemory() - memoryBefore;
+
+	++result.mCalls;
+	result.mTotalSeconds += elapsedSeconds;
+	result.mMaxSeconds = FMath::Max(result.mMaxSeconds, elapsedSeconds);
+}
+
+UObjectManagerBenchmarkCommandlet::UObjectManagerBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UObjectManagerBenchmarkCommandlet::Main(const FString& Params)
+{
+	FString countsParam = TEXT("100,1000,10000,100000");
+	FParse::Value(*Params, TEXT("Counts="), countsParam, false);
+
+	int32 numTicks = 300;
+	FParse::Value(*Params, TEXT("Ticks="), numTicks);
+
+	int32 seed = 1234;
+	FParse::Value(*Params, TEXT("Seed="), seed);
+
+	FString outputPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / TEXT("ObjectManagerBenchmark.csv");
+	FParse::Value(*Params, TEXT("Output="), outputPath);
+
+	UClass* managerClass = AObjectManagerComponent::StaticClass();
+
+	FString managerClassPath;
+	if (FParse::Value(*Params, TEXT("Manager="), managerClassPath))
+	{
+		managerClass = LoadClass<AObjectManagerComponent>(nullptr, *managerClassPath);
+		if (managerClass == nullptr)
+		{
+			UE_LOG(LogFyri, Error, TEXT("Couldn't load object manager class %s."), *managerClassPath);
+			return 1;
+		}
+	}
+
+	TArray<FString> counts;
+	countsParam.ParseIntoArray(counts, TEXT(","));
+
+	TArray<FBenchmarkResult> results;
+	for (const FString& count : counts)
+	{
+		const int32 numObjects = FCString::Atoi(*count);
+		if (numObjects > 0)
+		{
+			RunBenchmark(managerClass, numObjects, numTicks, seed, results);
+		}
+	}
+
+	const FString output = outputPath.EndsWith(TEXT(".json")) ? ToJson(results) : ToCsv(results);
+	if (!FFileHelper::SaveStringToFile(output, *outputPath))
+	{
+		UE_LOG(LogFyri, Error, TEXT("Couldn't write benchmark results to %s."), *outputPath);
+		return 1;
+	}
+
+	UE_LOG(LogFyri, Display, TEXT("Wrote benchmark results to %s."), *outputPath);
+	return 0;
+}
+
+void UObjectManagerBenchmarkCommandlet::RunBenchmark(UClass* managerClass, int32 numObjects, int32 numTicks, int32 seed, TArray<FBenchmarkResult>& outResults) const
+{
+	UWorld* world = UWorld::CreateWorld(EWorldType::Game, false, TEXT("ObjectManagerBenchmark"));
+	FWorldContext& worldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	worldContext.SetCurrentWorld(world);
+
+	world->InitializeActorsForPlay(FURL());
+	world->BeginPlay();
+
+	//Twice as many tiles as objects, so objects have free tiles around them as well as neighbors
+	const int32 sideLength = FMath::CeilToInt(FMath::Sqrt(numObjects * 2.f));
+
+	ATileGrid* tileGrid = world->SpawnActor<ATileGrid>();
+	const int32 grassDefinition = tileGrid->FindOrAddDefinition(ETileType::Grass, true, nullptr, nullptr);
+
+	TArray<int32> definitionIndices;
+	definitionIndices.Init(grassDefinition, sideLength * sideLength);
+	tileGrid->BuildFromDefinitions(FVector::ZeroVector, 100.f, sideLength, sideLength, definitionIndices);
+
+	//Same seed for every count, so each run plants the same way
+	AObjectManagerComponent* manager = world->SpawnActorDeferred<AObjectManagerComponent>(managerClass, FTransform::Identity);
+	manager->mRandomSeed = seed;
+	manager->FinishSpawning(FTransform::Identity);
+	manager->InitWithTileGrid(tileGrid);
+
+	FRandomStream tileRandomStream(seed);
+
+	TArray<int32> tiles;
+	tiles.Reserve(tileGrid->Num());
+	for (int32 tileIndex = 0; tileIndex < tileGrid->Num(); ++tileIndex)
+	{
+		tiles.Add(tileIndex);
+	}
+
+	for (int32 tile = tiles.Num() - 1; tile > 0; --tile)
+	{
+		tiles.Swap(tile, tileRandomStream.RandRange(0, tile));
+	}
+
+	tiles.SetNum(numObjects);
+
+	FBenchmarkResult getObjectClassResult;
+	getObjectClassResult.mFunction = TEXT("GetObjectClassToSpawn");
+
+	FBenchmarkResult spawnObjectResult;
+	spawnObjectResult.mFunction = TEXT("SpawnObjectAtTile");
+
+	FBenchmarkResult findNeighborsResult;
+	findNeighborsResult.mFunction = TEXT("FindNeighborsForObject");
+
+	FBenchmarkResult tickResult;
+	tickResult.mFunction = TEXT("Tick (warm-up)");
+
+	//The second half of the ticks, once the manager's arrays have grown to what they need
+	FBenchmarkResult steadyTickResult;
+	steadyTickResult.mFunction = TEXT("Tick (steady state)");
+
+	FBenchmarkResult spawnAnimalResult;
+	spawnAnimalResult.mFunction = TEXT("SpawnAnimal");
+
+	for (const int32 tileIndex : tiles)
+	{
+		TSubclassOf<APlantableObject> objectClass;
+		Measure(getObjectClassResult, [&]() { objectClass = manager->GetObjectClassToSpawn(); });
+
+		//..The native manager has no inventory to pick from
+		if (objectClass == nullptr)
+		{
+			objectClass = APlantableObject::StaticClass();
+		}
+
+		//SpawnObject itself picks the tile under the cursor, there is no cursor here
+		Measure(spawnObjectResult, [&]() { manager->SpawnObjectAtTile(objectClass, tileIndex); });
+	}
+
+	for (const int32 tileIndex : tiles)
+	{
+		Measure(findNeighborsResult, [&]() { manager->FindNeighborsForObject(tileIndex); });
+	}
+
+	const float deltaSeconds = 1.f / 30.f;
+	for (int32 tick = 0; tick < numTicks; ++tick)
+	{
+		Measure(tick < numTicks / 2 ? tickResult : steadyTickResult, [&]() { manager->Tick(deltaSeconds); });
+	}
+
+	if (steadyTickResult.mMemoryGrowthBytes > 0)
+	{
+		UE_LOG(LogFyri, Warning, TEXT("%d objects: memory still grew by %lld bytes over the manager ticks once warmed up."), numObjects, steadyTickResult.mMemoryGrowthBytes);
+	}
+
+	const TSubclassOf<AAnimalCharacter>* animalClass = manager->mAnimalInventory.FindByPredicate([](const TSubclassOf<AAnimalCharacter>& animal) { return animal != nullptr; });
+	if (animalClass != nullptr)
+	{
+		const int32 numAnimals = FMath::Min(numObjects, 100);
+		for (int32 animal = 0; animal < numAnimals; ++animal)
+		{
+			//..Spawn right away rather than queueing for the next frame
+			manager->mAnimalSpawnsThisFrame = 0;
+			Measure(spawnAnimalResult, [&]() { manager->SpawnAnimal(*animalClass); });
+		}
+	}
+
+	for (FBenchmarkResult* result : { &getObjectClassResult, &spawnObjectResult, &findNeighborsResult, &tickResult, &steadyTickResult, &spawnAnimalResult })
+	{
+		if (result->mCalls == 0)
+			continue;
+
+		result->mNumObjects = numObjects;
+		outResults.Add(*result);
+
+		UE_LOG(LogFyri, Display, TEXT("%7d objects  %-24s %8d calls  %10.3f ms total  %10.3f us avg  %10.3f us max  %10.1f bytes grown/call"),
+			numObjects, *result->mFunction, result->mCalls, result->mTotalSeconds * 1000.0, result->mTotalSeconds * 1000000.0 / result->mCalls,
+			result->mMaxSeconds * 1000000.0, static_cast<double>(result->mMemoryGrowthBytes) / result->mCalls);
+	}
+
+	GEngine->DestroyWorldContext(world);
+	world->DestroyWorld(false);
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+}
+
+FString UObjectManagerBenchmarkCommandlet::ToCsv(const TArray<FBenchmarkResult>& results)
+{
+	FString csv = TEXT("Objects,Function,Calls,TotalMs,AverageUs,MaxUs,MemoryGrowthBytesPerCall\n");
+
+	for (const FBenchmarkResult& result : results)
+	{
+		csv += FString::Printf(TEXT("%d,%s,%d,%.4f,%.4f,%.4f,%.4f\n"),
+			result.mNumObjects, *result.mFunction, result.mCalls, result.mTotalSeconds * 1000.0, result.mTotalSeconds * 1000000.0 / result.mCalls,
+			result.mMaxSeconds * 1000000.0, static_cast<double>(result.mMemoryGrowthBytes) / result.mCalls);
+	}
+
+	return csv;
+}
+
+FString UObjectManagerBenchmarkCommandlet::ToJson(const TArray<FBenchmarkResult>& results)
+{
+	FString json = TEXT("[\n");
+
+	for (int32 resultIndex = 0; resultIndex < results.Num(); ++resultIndex)
+	{
+		const FBenchmarkResult& result = results[resultIndex];
+
+		json += FString::Printf(TEXT("\t{ \"objects\": %d, \"function\": \"%s\", \"calls\": %d, \"totalMs\": %.4f, \"averageUs\": %.4f, \"maxUs\": %.4f, \"memoryGrowthBytesPerCall\": %.4f }%s\n"),
+			result.mNumObjects, *result.mFunction, result.mCalls, result.mTotalSeconds * 1000.0, result.mTotalSeconds * 1000000.0 / result.mCalls,
+			result.mMaxSeconds * 1000000.0, static_cast<double>(result.mMemoryGrowthBytes) / result.mCalls, resultIndex + 1 < results.Num() ? TEXT(",") : TEXT(""));
+	}
+
+	json += TEXT("]\n");
+	return json;
+}
@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PlantableArchetype.h"
+#include "Engine/StaticMesh.h"
+
+UPlantableArchetype::UPlantableArchetype()
+	: mIndex(0)
+	, mSpawnTier(ESpawnTier::Normal)
+	, mObjectType(EPlantableObjectType::Plant)
+	, mTimeUntilNextGrowingStage(60.f)
+{
+	for (uint8 stage = 0; stage < static_cast<uint8>(EGrowingStage::MAX); ++stage)
+	{
+		mStageMeshes[stage] = nullptr;
+		mStageDurations[stage] = 0.f;
+	}
+}
+
+bool UPlantableArchetype::HasAnyStageMesh() const
+{
+	for (const UStaticMesh* mesh : mStageMeshes)
+	{
+		if (mesh != nullptr)
+			return true;
+	}
+
+	return false;
+}
+
+float UPlantableArchetype::GetStageDuration(EGrowingStage stage) const
+{
+	const float stageDuration = mStageDurations[static_cast<uint8>(stage)];
+	return stageDuration > 0.f ? stageDuration : mTimeUntilNextGrowingStage;
+}
@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PlantableInstancer.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+
+UPlantableInstancer::UPlantableInstancer()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UPlantableInstancer::SetInstanceMesh(FPlantableInstanceHandle& handle, UStaticMesh* mesh, const FTransform& worldTransform)
+{
+	const int32 componentIndex = GetOrCreateComponent(mesh);
+
+	if (handle.mComponentIndex == componentIndex)
+	{
+		mComponents[componentIndex]->UpdateInstanceTransform(handle.mInstanceIndex, worldTransform, true, false, true);
+		mDirtyComponents[componentIndex] = true;
+		return;
+	}
+
+	RemoveInstance(handle);
+
+	UHierarchicalInstancedStaticMeshComponent* component = mComponents[componentIndex];
+	TArray<int32>& freeInstances = mFreeInstances[componentIndex];
+
+	handle.mComponentIndex = componentIndex;
+
+	if (freeInstances.Num() > 0)
+	{
+		handle.mInstanceIndex = freeInstances.Pop(false);
+		component->UpdateInstanceTransform(handle.mInstanceIndex, worldTransform, true, false, true);
+	}
+	else
+	{
+		handle.mInstanceIndex = component->AddInstanceWorldSpace(worldTransform);
+	}
+
+	mDirtyComponents[componentIndex] = true;
+}
+
+void UPlantableInstancer::RemoveInstance(FPlantableInstanceHandle& handle)
+{
+	if (!handle.IsValid())
+		return;
+
+	//Hide it by scaling it to nothing rather than removing it, which would change the index of other instances.
+	const FTransform hiddenTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector);
+	mComponents[handle.mComponentIndex]->UpdateInstanceTransform(handle.mInstanceIndex, hiddenTransform, false, false, true);
+
+	mFreeInstances[handle.mComponentIndex].Add(handle.mInstanceIndex);
+	mDirtyComponents[handle.mComponentIndex] = true;
+
+	handle = FPlantableInstanceHandle();
+}
+
+void UPlantableInstancer::FlushRenderState()
+{
+	for (TConstSetBitIterator<> it(mDirtyComponents); it; ++it)
+	{
+		mComponents[it.GetIndex()]->MarkRenderStateDirty();
+	}
+
+	mDirtyComponents.Init(false, mComponents.Num());
+}
+
+int32 UPlantableInstancer::GetOrCreateComponent(UStaticMesh* mesh)
+{
+	if (const int32* componentIndex = mComponentIndices.Find(mesh))
+		return *componentIndex;
+
+	UHierarchicalInstancedStaticMeshComponent* component = NewObject<UHierarchicalInstancedStaticMeshComponent>(GetOwner());
+	component->SetMobility(EComponentMobility::Movable);
+	component->SetupAttachment(this);
+	component->SetStaticMesh(mesh);
+	component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	component->RegisterComponent();
+
+	const int32 componentIndex = mComponents.Add(component);
+	mComponentIndices.Add(mesh, componentIndex);
+	mFreeInstances.AddDefaulted();
+	mDirtyComponents.Add(false);
+
+	return componentIndex;
+}
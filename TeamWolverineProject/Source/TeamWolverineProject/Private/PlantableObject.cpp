@@ -1,16 +1,105 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 #include "PlantableObject.h"
-#include "Tile.h"
+#include "TileGrid.h"
+#include "ObjectManager.h"
+#include "TeamWolverineProject.h"
 #include "Components/StaticMeshComponent.h"
 #include "Engine/StaticMesh.h"
+#include "FyriStats.h"
+
+FPlantSignificanceSettings::FPlantSignificanceSettings()
+	: mIsEnabled(true)
+	, mDormantDistance(8000.f)
+	, mFrustumMarginDegrees(10.f)
+	, mUpdatesPerFrame(256)
+	, mDormantEvaluationInterval(1.f)
+{
+}
 
 APlantableObject::APlantableObject()
-	: mCurrentGrowingStage(EGrowingStage::Sprout),
-	mObjectType(EPlantableObjectType::Plant)
-	, mTimeUntilNextGrowingStage(60.f)
-	, mTimeSpentInCurrentStage(0.f)
+	: mCurrentGrowingStage(EGrowingStage::Sprout)
+	, mTileGrid(nullptr)
+	, mCurrentTile(INDEX_NONE)
+	, mObjectManager(nullptr)
+	, mIsQueuedForInteractionUpdate(false)
+	, mGrowthTimerSerial(0)
+	, mGrowthDeadline(0.0)
+	, mIsDormant(false)
+	, mInstancer(nullptr)
+{
+	//Growing is scheduled by the object manager, so there's nothing to do per frame.
+	PrimaryActorTick.bCanEverTick = false;
+
+	mArchetype = nullptr;
+	mMeshComponent = nullptr;
+	mDefaultMesh = nullptr;
+	mDefaultCollision = ECollisionEnabled::QueryAndPhysics;
+
+#if WITH_EDITORONLY_DATA
+	mObjectType = EPlantableObjectType::Plant;
+	mTimeUntilNextGrowingStage = 60.f;
+	mIndex = 0;
+	mSpawnTier = ESpawnTier::Normal;
+#endif
+}
+
+#if WITH_EDITOR
+void APlantableObject::PostLoad()
+{
+	Super::PostLoad();
+
+	if (HasAnyFlags(RF_ClassDefaultObject) && mArchetype == nullptr && mPlantableMeshes.Num() > 0)
+	{
+		UE_LOG(LogFyri, Warning, TEXT("%s has no plantable archetype, using one built from its Legacy settings for now. Assign it an archetype asset, it won't cook without one."), *GetClass()->GetName());
+		mArchetype = CreateArchetypeFromLegacyData();
+	}
+}
+
+void APlantableObject::PreSave(const ITargetPlatform* TargetPlatform)
+{
+	Super::PreSave(TargetPlatform);
+
+	//..Only when cooking, the Legacy settings the editor falls back on aren't in cooked builds
+	const bool isCooking = TargetPlatform != nullptr;
+	const bool hasArchetypeAsset = mArchetype != nullptr && !mArchetype->HasAnyFlags(RF_Transient);
+
+	if (isCooking && HasAnyFlags(RF_ClassDefaultObject) && !GetClass()->HasAnyClassFlags(CLASS_Abstract) && !hasArchetypeAsset)
+	{
+		UE_LOG(LogFyri, Error, TEXT("%s has no plantable archetype asset, every plantable of it would be invisible in this build. Assign it an archetype asset."), *GetClass()->GetName());
+	}
+}
+
+UPlantableArchetype* APlantableObject::CreateArchetypeFromLegacyData()
+{
+	UPlantableArchetype* archetype = NewObject<UPlantableArchetype>(GetTransientPackage(), NAME_None, RF_Transient);
+	archetype->mIndex = mIndex;
+	archetype->mSpawnTier = mSpawnTier;
+	archetype->mObjectType = mObjectType;
+	archetype->mTimeUntilNextGrowingStage = mTimeUntilNextGrowingStage;
+
+	for (const TPair<EGrowingStage, UStaticMesh*>& stageMesh : mPlantableMeshes)
+	{
+		if (stageMesh.Key < EGrowingStage::MAX)
+		{
+			archetype->mStageMeshes[static_cast<uint8>(stageMesh.Key)] = stageMesh.Value;
+		}
+	}
+
+	return archetype;
+}
+#endif
+
+void APlantableObject::PostInitializeComponents()
 {
-	PrimaryActorTick.bCanEverTick = true;
+	Super::PostInitializeComponents();
+
+	mMeshComponent = FindComponentByClass<UStaticMeshComponent>();
+
+	if (mMeshComponent != nullptr)
+	{
+		mDefaultMesh = mMeshComponent->GetStaticMesh();
+		mDefaultCollision = mMeshComponent->GetCollisionEnabled();
+	}
 }
 
 void APlantableObject::BeginPlay()
@@ -20,45 +109,103 @@ void APlantableObject::BeginPlay()
 	SetMeshToMatchGrowingState();
 }
 
-bool APlantableObject::SetMeshToMatchGrowingState()
+void APlantableObject::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	if (UStaticMeshComponent* meshComponent = FindComponentByClass<UStaticMeshComponent>())
+	if (mInstancer != nullptr && !mInstancer->IsPendingKill())
 	{
-		if (mPlantableMeshes.Contains(mCurrentGrowingStage) && mPlantableMeshes[mCurrentGrowingStage] != nullptr)
-		{
-			meshComponent->SetStaticMesh(mPlantableMeshes[mCurrentGrowingStage]);
-			meshComponent->SetMaterial(0, mPlantableMeshes[mCurrentGrowingStage]->GetMaterial(0));
-			return true;
-		}
+		mInstancer->RemoveInstance(mInstanceHandle);
 	}
 
-	return false;
+	Super::EndPlay(EndPlayReason);
 }
 
-void APlantableObject::Tick(float DeltaTime)
+void APlantableObject::OnAcquiredFromPool()
 {
-	Super::Tick(DeltaTime);
+	if (mMeshComponent != nullptr)
+	{
+		mMeshComponent->SetStaticMesh(mDefaultMesh);
+		mMeshComponent->SetCollisionEnabled(mDefaultCollision);
+	}
+
+	SetMeshToMatchGrowingState();
+}
 
-	if (mCurrentGrowingStage < EGrowingStage::MAX && mPlantableMeshes.Num() > 0)
+void APlantableObject::OnReturnedToPool()
+{
+	if (mInstancer != nullptr)
 	{
-		mTimeSpentInCurrentStage += DeltaTime;
+		mInstancer->RemoveInstance(mInstanceHandle);
+		mInstancer = nullptr;
+	}
 
-		if (mTimeSpentInCurrentStage >= mTimeUntilNextGrowingStage)
-		{
-			Grow();
-			mTimeSpentInCurrentStage = 0.f;
-		}
+	//..Any growth timer still in the scheduler goes stale.
+	++mGrowthTimerSerial;
+
+	mCurrentGrowingStage = EGrowingStage::Sprout;
+	mNeighbors = FPlantableNeighbors();
+	mObjectManager = nullptr;
+	mTileGrid = nullptr;
+	mCurrentTile = INDEX_NONE;
+	mIsQueuedForInteractionUpdate = false;
+	mGrowthDeadline = 0.0;
+	mIsDormant = false;
+	mEntityHandle = FEntityHandle();
+}
+
+void APlantableObject::EnableInstancedRendering(UPlantableInstancer* instancer)
+{
+	if (mMeshComponent == nullptr)
+		return;
+
+	mInstancer = instancer;
+
+	if (!SetMeshToMatchGrowingState() && mMeshComponent->GetStaticMesh() != nullptr)
+	{
+		//..No mesh for this stage, so keep showing the one the blueprint came with.
+		mInstancer->SetInstanceMesh(mInstanceHandle, mMeshComponent->GetStaticMesh(), mMeshComponent->GetComponentTransform());
+	}
+
+	mMeshComponent->SetStaticMesh(nullptr);
+	mMeshComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+}
+
+bool APlantableObject::SetMeshToMatchGrowingState()
+{
+	UStaticMesh* stageMesh = GetArchetype()->GetStageMesh(mCurrentGrowingStage);
+
+	if (mMeshComponent == nullptr || stageMesh == nullptr)
+		return false;
+
+	if (mInstancer != nullptr)
+	{
+		//The component's transform still holds the random scale and yaw from spawning.
+		mInstancer->SetInstanceMesh(mInstanceHandle, stageMesh, mMeshComponent->GetComponentTransform());
+		return true;
 	}
+
+	mMeshComponent->SetStaticMesh(stageMesh);
+	mMeshComponent->SetMaterial(0, stageMesh->GetMaterial(0));
+	return true;
+}
+
+bool APlantableObject::CanGrow() const
+{
+	return mCurrentGrowingStage < EGrowingStage::VeryOld && GetArchetype()->HasAnyStageMesh();
+}
+
+float APlantableObject::GetTimeUntilNextGrowingStage() const
+{
+	return GetArchetype()->GetStageDuration(mCurrentGrowingStage);
 }
 
 bool APlantableObject::HasInteractedWithNeighborBefore(ENeighborLocationType neighborLocationType) const
 {
-	return mNeighborsWeHaveHadInteractionWith.Contains(neighborLocationType);
+	return mNeighbors.HasInteractedWith(neighborLocationType);
 }
 
 bool APlantableObject::HasInteractedWithCurrentTileBefore() const
 {
-	return mCurrentTile->HasBeenInteractedWith();
+	return mTileGrid->HasBeenInteractedWith(mCurrentTile);
 }
 
 ENeighborLocationType APlantableObject::GetOppositeLocationType(ENeighborLocationType originalType)
@@ -73,42 +220,124 @@ ENeighborLocationType APlantableObject::GetOppositeLocationType(ENeighborLocatio
 		return ENeighborLocationType::Up;
 }
 
-void APlantableObject::OnSpawn(ATile* closestTile, const TMap<ENeighborLocationType, APlantableObject*>& neighbors)
+bool APlantableObject::MarkQueuedForInteractionUpdate()
+{
+	if (mIsQueuedForInteractionUpdate)
+		return false;
+
+	mIsQueuedForInteractionUpdate = true;
+	return true;
+}
+
+void APlantableObject::OnSpawn(AObjectManagerComponent* objectManager, ATileGrid* tileGrid, int32 tileIndex, const FPlantableNeighbors& neighbors)
 {
-	mCurrentTile = closestTile;
+	mObjectManager = objectManager;
+	mTileGrid = tileGrid;
+	mCurrentTile = tileIndex;
 	mNeighbors = neighbors;
 }
 
+void APlantableObject::SetCurrentTile(ATileGrid* tileGrid, int32 tileIndex)
+{
+	mTileGrid = tileGrid;
+	mCurrentTile = tileIndex;
+	mNeighbors.MarkDebugLabelDirty();
+}
+
 void APlantableObject::SetNeighbor(APlantableObject* newNeighbor, ENeighborLocationType locationType)
 {
-	if (mNeighbors.Contains(locationType))
+	mNeighbors.Set(locationType, newNeighbor);
+
+	if (mObjectManager != nullptr)
 	{
-		mNeighbors[locationType] = newNeighbor;
+		mObjectManager->QueueInteractionUpdate(this);
 	}
-	else
+}
+
+void APlantableObject::Grow()
+{
+	SCOPE_CYCLE_COUNTER(STAT_PlantableGrow);
+
+	if (!AdvanceToNextGrowingStage())
+		return;
+
+	SetMeshToMatchGrowingState();
+	OnGrown(1, true);
+}
+
+bool APlantableObject::AdvanceGrowth(double currentTime, double extraSeconds, bool coalesceGrowEvents)
+{
+	SCOPE_CYCLE_COUNTER(STAT_PlantableGrow);
+
+	const double targetTime = currentTime + extraSeconds;
+	int32 numStagesGrown = 0;
+
+	//At most one pass per stage, however much time it is
+	while (CanGrow() && mGrowthDeadline <= targetTime)
 	{
-		mNeighbors.Add(locationType, newNeighbor);
+		if (!AdvanceToNextGrowingStage())
+			break;
+
+		mGrowthDeadline += GetTimeUntilNextGrowingStage();
+		++numStagesGrown;
 	}
+
+	//..The time left in the stage it ended up in counts from now
+	mGrowthDeadline -= extraSeconds;
+
+	if (numStagesGrown == 0)
+		return false;
+
+	SetMeshToMatchGrowingState();
+	OnGrown(numStagesGrown, coalesceGrowEvents);
+	return true;
 }
 
-void APlantableObject::Grow()
+void APlantableObject::AdvanceTime(float seconds, bool coalesceGrowEvents)
 {
-	bool succeededToGrow = false;
-	while (!succeededToGrow)
+	//Growth is driven by the manager's scheduler, so it has to reschedule the object
+	if (mObjectManager != nullptr && seconds > 0.f)
 	{
-		const uint8 nextStageAsInt = static_cast<uint8>(mCurrentGrowingStage) + 1;
-		const uint8 maxEnumValueAsInt = static_cast<uint8>(EGrowingStage::MAX) - 1;
+		mObjectManager->AdvanceObjectTime(this, seconds, coalesceGrowEvents);
+	}
+}
 
-		if (nextStageAsInt > maxEnumValueAsInt)
-			return;
+bool APlantableObject::AdvanceToNextGrowingStage()
+{
+	const UPlantableArchetype* archetype = GetArchetype();
+
+	for (uint8 stage = static_cast<uint8>(mCurrentGrowingStage) + 1; stage < static_cast<uint8>(EGrowingStage::MAX); ++stage)
+	{
+		if (archetype->GetStageMesh(static_cast<EGrowingStage>(stage)) != nullptr)
+		{
+			mCurrentGrowingStage = static_cast<EGrowingStage>(stage);
+			return true;
+		}
+	}
 
-		mCurrentGrowingStage = static_cast<EGrowingStage>(nextStageAsInt);
+	//..No later stage has a mesh, so it has nothing left to grow into
+	mCurrentGrowingStage = EGrowingStage::VeryOld;
+	return false;
+}
 
-		succeededToGrow = SetMeshToMatchGrowingState();
+void APlantableObject::OnGrown(int32 numStagesGrown, bool coalesceGrowEvents)
+{
+	if (mObjectManager != nullptr)
+	{
+		mObjectManager->QueueInteractionUpdate(this);
+	}
 
-		//send Grow-event to BPs, for playing event
+	if (!coalesceGrowEvents)
+	{
+		for (int32 stage = 1; stage < numStagesGrown; ++stage)
+		{
+			INC_DWORD_STAT(STAT_BlueprintEvents);
+			OnGrow();
+		}
 	}
 
+	INC_DWORD_STAT(STAT_BlueprintEvents);
+
 	if (mCurrentGrowingStage >= EGrowingStage::VeryOld)
 	{
 		OnFinalGrow();
@@ -122,16 +351,45 @@ void APlantableObject::Grow()
 
 void APlantableObject::OnInteractWithNeighbor(ENeighborLocationType locationTypeForNeighbor)
 {
-	mNeighborsWeHaveHadInteractionWith.Add(locationTypeForNeighbor);
+	mNeighbors.MarkInteractedWith(locationTypeForNeighbor);
 }
 
 void APlantableObject::OnInteractWithTile()
 {
-	mCurrentTile->OnInteractWithObjectOnTile();
+	mTileGrid->OnInteractWithObjectOnTile(mCurrentTile);
+	mNeighbors.MarkDebugLabelDirty();
+}
+
+#if ENABLE_DRAW_DEBUG
+const FString& APlantableObject::GetDebugLabel() const
+{
+	if (!mNeighbors.mIsDebugLabelDirty)
+		return mDebugLabel;
+
+	static const TCHAR* const slotNames[FPlantableNeighbors::NumSlots] = { TEXT("Left"), TEXT("Right"), TEXT("Up"), TEXT("Down") };
+
+	mDebugLabel = TEXT("Neighbors:\n");
+	for (uint8 slot = 0; slot < FPlantableNeighbors::NumSlots; ++slot)
+	{
+		const ENeighborLocationType locationType = static_cast<ENeighborLocationType>(slot);
+		const APlantableObject* neighbor = mNeighbors.Get(locationType);
+
+		mDebugLabel += FString::Printf(TEXT("%s: %s%s\n"), slotNames[slot], neighbor != nullptr ? *neighbor->GetName() : TEXT("-"),
+			mNeighbors.HasInteractedWith(locationType) ? TEXT(" (interacted)") : TEXT(""));
+	}
+
+	if (HasInteractedWithCurrentTileBefore())
+	{
+		mDebugLabel += TEXT("Tile: interacted\n");
+	}
+
+	mNeighbors.mIsDebugLabelDirty = false;
+	return mDebugLabel;
 }
+#endif
 
 ETileType APlantableObject::GetTileTypeForCurrentTile() const
 {
-	return mCurrentTile->GetTileType();
+	return mTileGrid->GetTileType(mCurrentTile);
 }
 
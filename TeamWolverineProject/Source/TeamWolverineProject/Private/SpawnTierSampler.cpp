@@ -0,0 +1,134 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SpawnTierSampler.h"
+#include "TeamWolverineProject.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+
+constexpr uint8 FSpawnTierSampler::NumTiers;
+
+FSpawnTierSampler::FSpawnTierSampler()
+{
+	Build(1.f, 0.f, 0.f);
+}
+
+void FSpawnTierSampler::Build(float commonWeight, float fancyWeight, float mythicalWeight)
+{
+	const float weights[NumTiers] = { FMath::Max(commonWeight, 0.f), FMath::Max(fancyWeight, 0.f), FMath::Max(mythicalWeight, 0.f) };
+	const float totalWeight = weights[0] + weights[1] + weights[2];
+
+	//Scaled so the average column is 1, columns under 1 get topped up by a column over 1 (Vose's method)
+	float scaledWeights[NumTiers];
+	uint8 small[NumTiers];
+	uint8 large[NumTiers];
+	uint8 numSmall = 0;
+	uint8 numLarge = 0;
+
+	for (uint8 tier = 0; tier < NumTiers; ++tier)
+	{
+		mNormalizedWeights[tier] = totalWeight > 0.f ? weights[tier] / totalWeight : (tier == 0 ? 1.f : 0.f);
+		scaledWeights[tier] = mNormalizedWeights[tier] * NumTiers;
+		mAliases[tier] = tier;
+
+		if (scaledWeights[tier] < 1.f)
+		{
+			small[numSmall++] = tier;
+		}
+		else
+		{
+			large[numLarge++] = tier;
+		}
+	}
+
+	while (numSmall > 0 && numLarge > 0)
+	{
+		const uint8 smallTier = small[--numSmall];
+		const uint8 largeTier = large[--numLarge];
+
+		mProbabilities[smallTier] = scaledWeights[smallTier];
+		mAliases[smallTier] = largeTier;
+
+		scaledWeights[largeTier] -= 1.f - scaledWeights[smallTier];
+		if (scaledWeights[largeTier] < 1.f)
+		{
+			small[numSmall++] = largeTier;
+		}
+		else
+		{
+			large[numLarge++] = largeTier;
+		}
+	}
+
+	//..What's left is 1 give or take rounding
+	while (numLarge > 0)
+	{
+		mProbabilities[large[--numLarge]] = 1.f;
+	}
+
+	while (numSmall > 0)
+	{
+		mProbabilities[small[--numSmall]] = 1.f;
+	}
+}
+
+ESpawnTier FSpawnTierSampler::Sample(float random) const
+{
+	const float scaledRandom = random * NumTiers;
+	const uint8 column = FMath::Min(static_cast<uint8>(scaledRandom), static_cast<uint8>(NumTiers - 1));
+	const float side = scaledRandom - column;
+
+	return GetTier(side < mProbabilities[column] ? column : mAliases[column]);
+}
+
+#if !UE_BUILD_SHIPPING
+//Draws from a sampler and compares how often each tier came up with its probability, with a chi-squared test.
+static FAutoConsoleCommand GCheckSpawnTierSamplerCommand(
+	TEXT("Fyri.CheckSpawnTierSampler"),
+	TEXT("Checks the spawn tier sampler's distribution. Fyri.CheckSpawnTierSampler <common> <fancy> <mythical> [draws, 10000000 by default] [seed]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic([](const TArray<FString>& args)
+	{
+		if (args.Num() < 3)
+			return;
+
+		const float weights[FSpawnTierSampler::NumTiers] = { FCString::Atof(*args[0]), FCString::Atof(*args[1]), FCString::Atof(*args[2]) };
+		const int32 numDraws = args.Num() > 3 ? FCString::Atoi(*args[3]) : 10000000;
+		const int32 seed = args.Num() > 4 ? FCString::Atoi(*args[4]) : 1234;
+
+		FSpawnTierSampler sampler;
+		sampler.Build(weights[0], weights[1], weights[2]);
+
+		FRandomStream randomStream(seed);
+		int64 counts[FSpawnTierSampler::NumTiers] = { 0, 0, 0 };
+
+		for (int32 draw = 0; draw < numDraws; ++draw)
+		{
+			++counts[static_cast<uint8>(sampler.Sample(randomStream.GetFraction())) - static_cast<uint8>(ESpawnTier::Common)];
+		}
+
+		double chiSquared = 0.0;
+		int32 degreesOfFreedom = -1;
+		bool hasImpossibleDraws = false;
+
+		for (uint8 tier = 0; tier < FSpawnTierSampler::NumTiers; ++tier)
+		{
+			const double expected = static_cast<double>(sampler.GetProbability(tier)) * numDraws;
+			if (expected > 0.0)
+			{
+				chiSquared += FMath::Square(counts[tier] - expected) / expected;
+				++degreesOfFreedom;
+			}
+			else
+			{
+				hasImpossibleDraws |= counts[tier] > 0;
+			}
+
+			UE_LOG(LogFyri, Display, TEXT("Tier %d: expected %.5f, sampled %.5f"), tier, sampler.GetProbability(tier), static_cast<double>(counts[tier]) / numDraws);
+		}
+
+		//..Critical values at p = 0.001 for 0, 1 and 2 degrees of freedom
+		const double criticalValues[FSpawnTierSampler::NumTiers] = { 0.0, 10.828, 13.816 };
+		const bool hasPassed = !hasImpossibleDraws && chiSquared <= criticalValues[FMath::Max(degreesOfFreedom, 0)];
+
+		UE_LOG(LogFyri, Display, TEXT("Chi-squared %.3f over %d draws with %d degrees of freedom: %s"), chiSquared, numDraws, degreesOfFreedom, hasPassed ? TEXT("PASSED") : TEXT("FAILED"));
+	}));
+#endif
@@ -0,0 +1,382 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TileGrid.h"
+#include "Tile.h"
+#include "Components/SceneComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/CollisionProfile.h"
+#include "Materials/MaterialInterface.h"
+
+#define BIG_FLOAT 99999999999.f
+
+FTileDefinition::FTileDefinition()
+	: mTileType(ETileType::Grass)
+	, mIsTraversable(true)
+	, mMesh(nullptr)
+	, mMaterial(nullptr)
+{
+}
+
+ATileGrid::ATileGrid()
+	: mOrigin(FVector::ZeroVector)
+	, mTileSize(0.f)
+	, mRows(0)
+	, mColumns(0)
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	//Static so the tile meshes can be, the grid never moves
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+	RootComponent->SetMobility(EComponentMobility::Static);
+}
+
+void ATileGrid::BuildFromTileActors(const TArray<ATile*>& tiles)
+{
+	if (tiles.Num() == 0)
+	{
+		ResetGrid(FVector::ZeroVector, 0.f, 0, 0);
+		OnGridRebuilt.Broadcast();
+		return;
+	}
+
+	TArray<float> xPositions;
+	TArray<float> yPositions;
+	xPositions.Reserve(tiles.Num());
+	yPositions.Reserve(tiles.Num());
+
+	FVector minLocation(BIG_FLOAT, BIG_FLOAT, tiles[0]->GetActorLocation().Z);
+	FVector maxLocation(-BIG_FLOAT, -BIG_FLOAT, tiles[0]->GetActorLocation().Z);
+
+	for (ATile* tile : tiles)
+	{
+		const FVector location = tile->GetActorLocation();
+		xPositions.Add(location.X);
+		yPositions.Add(location.Y);
+
+		minLocation.X = FMath::Min(minLocation.X, location.X);
+		minLocation.Y = FMath::Min(minLocation.Y, location.Y);
+		maxLocation.X = FMath::Max(maxLocation.X, location.X);
+		maxLocation.Y = FMath::Max(maxLocation.Y, location.Y);
+	}
+
+	//The tile size is the smallest spacing between two tiles along either axis
+	xPositions.Sort();
+	yPositions.Sort();
+
+	const float minTileSpacing = 1.f;
+	float tileSize = BIG_FLOAT;
+	for (const TArray<float>* positions : { &xPositions, &yPositions })
+	{
+		for (int32 i = 1; i < positions->Num(); ++i)
+		{
+			const float spacing = (*positions)[i] - (*positions)[i - 1];
+			if (spacing > minTileSpacing && spacing < tileSize)
+			{
+				tileSize = spacing;
+			}
+		}
+	}
+
+	//..If there is only one tile there is no spacing to measure, so use its bounds instead.
+	if (tileSize == BIG_FLOAT)
+	{
+		tileSize = FMath::Max(tiles[0]->GetComponentsBoundingBox().GetSize().X, minTileSpacing);
+	}
+
+	const int32 rows = FMath::RoundToInt((maxLocation.X - minLocation.X) / tileSize) + 1;
+	const int32 columns = FMath::RoundToInt((maxLocation.Y - minLocation.Y) / tileSize) + 1;
+
+	ResetGrid(minLocation, tileSize, rows, columns);
+
+	for (ATile* tile : tiles)
+	{
+		const int32 tileIndex = GetTileIndexForLocation(tile->GetActorLocation());
+		if (!ensureMsgf(!IsValidTile(tileIndex), TEXT("Tile %s shares a grid slot with another tile!"), *tile->GetName()))
+		{
+			//..The slot already has its instance
+			tile->Destroy();
+			continue;
+		}
+
+		UStaticMeshComponent* meshComponent = tile->FindComponentByClass<UStaticMeshComponent>();
+		UStaticMesh* mesh = meshComponent != nullptr ? meshComponent->GetStaticMesh() : nullptr;
+		UMaterialInterface* material = meshComponent != nullptr ? meshComponent->GetMaterial(0) : nullptr;
+		const FTransform instanceTransform = meshComponent != nullptr ? meshComponent->GetComponentTransform() : tile->GetActorTransform();
+
+		const int32 definitionIndex = FindOrAddDefinition(tile->GetTileType(), tile->IsTraversable(), mesh, material);
+		SetTile(tileIndex, definitionIndex, instanceTransform);
+
+		tile->Destroy();
+	}
+
+	OnGridRebuilt.Broadcast();
+}
+
+void ATileGrid::BuildFromDefinitions(const FVector& origin, float tileSize, int32 rows, int32 columns, const TArray<int32>& definitionIndices)
+{
+	if (!ensureMsgf(definitionIndices.Num() == rows * columns, TEXT("Expected %d tile definition indices but got %d!"), rows * columns, definitionIndices.Num()))
+		return;
+
+	ResetGrid(origin, tileSize, rows, columns);
+
+	for (int32 tileIndex = 0; tileIndex < definitionIndices.Num(); ++tileIndex)
+	{
+		const int32 definitionIndex = definitionIndices[tileIndex];
+		if (mTileDefinitions.IsValidIndex(definitionIndex))
+		{
+			SetTile(tileIndex, definitionIndex, FTransform(GetTileLocation(tileIndex)));
+		}
+	}
+
+	OnGridRebuilt.Broadcast();
+}
+
+void ATileGrid::ResetGrid(const FVector& origin, float tileSize, int32 rows, int32 columns)
+{
+	for (UHierarchicalInstancedStaticMeshComponent* meshComponent : mMeshComponents)
+	{
+		if (meshComponent != nullptr)
+		{
+			meshComponent->ClearInstances();
+		}
+	}
+
+	mOrigin = origin;
+	mTileSize = tileSize;
+	mRows = rows;
+	mColumns = columns;
+
+	mTiles.Reset();
+	mTiles.SetNum(rows * columns);
+
+	mTraversableTiles.Reset(mTiles.Num());
+	mFreeTiles.Reset(mTiles.Num());
+}
+
+void ATileGrid::SetTile(int32 tileIndex, int32 definitionIndex, const FTransform& instanceTransform)
+{
+	const FTileDefinition& definition = mTileDefinitions[definitionIndex];
+
+	FTileData& tile = mTiles[tileIndex];
+	tile.mDefinitionIndex = static_cast<uint8>(definitionIndex);
+	tile.mTileType = definition.mTileType;
+	tile.mFlags = definition.mIsTraversable ? TileFlag_Traversable : 0;
+	UpdateTileSets(tileIndex);
+
+	if (UHierarchicalInstancedStaticMeshComponent* meshComponent = GetOrCreateMeshComponent(definitionIndex))
+	{
+		meshComponent->AddInstanceWorldSpace(instanceTransform);
+	}
+}
+
+int32 ATileGrid::FindOrAddDefinition(ETileType tileType, bool isTraversable, UStaticMesh* mesh, UMaterialInterface* material)
+{
+	const int32 definitionIndex = mTileDefinitions.IndexOfByPredicate([&](const FTileDefinition& definition)
+	{
+		return definition.mTileType == tileType && definition.mIsTraversable == isTraversable && definition.mMesh == mesh && definition.mMaterial == material;
+	});
+
+	if (definitionIndex != INDEX_NONE)
+		return definitionIndex;
+
+	ensureMsgf(mTileDefinitions.Num() < NoDefinition, TEXT("Too many different tile definitions!"));
+
+	FTileDefinition definition;
+	definition.mTileType = tileType;
+	definition.mIsTraversable = isTraversable;
+	definition.mMesh = mesh;
+	definition.mMaterial = material;
+
+	return mTileDefinitions.Add(definition);
+}
+
+UHierarchicalInstancedStaticMeshComponent* ATileGrid::GetOrCreateMeshComponent(int32 definitionIndex)
+{
+	if (mMeshComponents.Num() <= definitionIndex)
+	{
+		mMeshComponents.SetNumZeroed(definitionIndex + 1);
+	}
+
+	if (mMeshComponents[definitionIndex] == nullptr)
+	{
+		const FTileDefinition& definition = mTileDefinitions[definitionIndex];
+		if (definition.mMesh == nullptr)
+			return nullptr;
+
+		UHierarchicalInstancedStaticMeshComponent* meshComponent = NewObject<UHierarchicalInstancedStaticMeshComponent>(this);
+		meshComponent->SetMobility(EComponentMobility::Static);
+		meshComponent->SetupAttachment(RootComponent);
+		meshComponent->SetStaticMesh(definition.mMesh);
+		meshComponent->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+
+		if (definition.mMaterial != nullptr)
+		{
+			meshComponent->SetMaterial(0, definition.mMaterial);
+		}
+
+		meshComponent->RegisterComponent();
+		mMeshComponents[definitionIndex] = meshComponent;
+	}
+
+	return mMeshComponents[definitionIndex];
+}
+
+int32 ATileGrid::GetTileIndexForLocation(const FVector& location) const
+{
+	if (mRows == 0 || mColumns == 0)
+		return INDEX_NONE;
+
+	const int32 row = FMath::RoundToInt((location.X - mOrigin.X) / mTileSize);
+	const int32 column = FMath::RoundToInt((location.Y - mOrigin.Y) / mTileSize);
+
+	if (row < 0 || row >= mRows || column < 0 || column >= mColumns)
+		return INDEX_NONE;
+
+	return row * mColumns + column;
+}
+
+int32 ATileGrid::GetNeighborTileIndex(int32 tileIndex, ENeighborLocationType locationType) const
+{
+	const int32 row = tileIndex / mColumns;
+	const int32 column = tileIndex % mColumns;
+
+	//Right/Left is along Y and Up/Down is along X
+	switch (locationType)
+	{
+	case ENeighborLocationType::Right:
+		return column + 1 < mColumns ? tileIndex + 1 : INDEX_NONE;
+	case ENeighborLocationType::Left:
+		return column > 0 ? tileIndex - 1 : INDEX_NONE;
+	case ENeighborLocationType::Up:
+		return row + 1 < mRows ? tileIndex + mColumns : INDEX_NONE;
+	case ENeighborLocationType::Down:
+		return row > 0 ? tileIndex - mColumns : INDEX_NONE;
+	default:
+		return INDEX_NONE;
+	}
+}
+
+FVector ATileGrid::GetTileLocation(int32 tileIndex) const
+{
+	const int32 row = tileIndex / mColumns;
+	const int32 column = tileIndex % mColumns;
+
+	return mOrigin + FVector(row * mTileSize, column * mTileSize, 0.f);
+}
+
+void ATileGrid::GetTilesInRadius(const FVector& center, float radius, TArray<int32>& outTileIndices) const
+{
+	outTileIndices.Reset();
+
+	if (mRows == 0 || mColumns == 0 || radius < 0.f)
+		return;
+
+	const int32 minRow = FMath::Max(0, FMath::CeilToInt((center.X - radius - mOrigin.X) / mTileSize));
+	const int32 maxRow = FMath::Min(mRows - 1, FMath::FloorToInt((center.X + radius - mOrigin.X) / mTileSize));
+	const int32 minColumn = FMath::Max(0, FMath::CeilToInt((center.Y - radius - mOrigin.Y) / mTileSize));
+	const int32 maxColumn = FMath::Min(mColumns - 1, FMath::FloorToInt((center.Y + radius - mOrigin.Y) / mTileSize));
+
+	const float radiusSquared = radius * radius;
+
+	for (int32 row = minRow; row <= maxRow; ++row)
+	{
+		for (int32 column = minColumn; column <= maxColumn; ++column)
+		{
+			const int32 tileIndex = row * mColumns + column;
+
+			if (IsValidTile(tileIndex) && FVector::DistSquared2D(GetTileLocation(tileIndex), center) <= radiusSquared)
+			{
+				outTileIndices.Add(tileIndex);
+			}
+		}
+	}
+}
+
+void ATileGrid::OnInteractWithObjectOnTile(int32 tileIndex)
+{
+	mTiles[tileIndex].mFlags |= TileFlag_InteractedWith;
+}
+
+void ATileGrid::OnObjectSpawnOnTile(int32 tileIndex)
+{
+	mTiles[tileIndex].mFlags |= TileFlag_Used;
+	UpdateTileSets(tileIndex);
+}
+
+void ATileGrid::OnObjectRemovedFromTile(int32 tileIndex)
+{
+	mTiles[tileIndex].mFlags &= ~TileFlag_Used;
+	UpdateTileSets(tileIndex);
+}
+
+void ATileGrid::SetTraversable(int32 tileIndex, bool isTraversable)
+{
+	if (!IsValidTile(tileIndex) || IsTraversable(tileIndex) == isTraversable)
+		return;
+
+	if (isTraversable)
+	{
+		mTiles[tileIndex].mFlags |= TileFlag_Traversable;
+	}
+	else
+	{
+		mTiles[tileIndex].mFlags &= ~TileFlag_Traversable;
+	}
+
+	UpdateTileSets(tileIndex);
+	OnTraversabilityChanged.Broadcast(tileIndex, isTraversable);
+}
+
+void ATileGrid::UpdateTileSets(int32 tileIndex)
+{
+	const bool isTraversable = IsValidTile(tileIndex) && IsTraversable(tileIndex);
+
+	if (isTraversable)
+	{
+		mTraversableTiles.Add(tileIndex);
+	}
+	else
+	{
+		mTraversableTiles.Remove(tileIndex);
+	}
+
+	if (isTraversable && !IsUsed(tileIndex))
+	{
+		mFreeTiles.Add(tileIndex);
+	}
+	else
+	{
+		mFreeTiles.Remove(tileIndex);
+	}
+}
+
+void ATileGrid::FTileSet::Reset(int32 numTiles)
+{
+	mTileIndices.Reset();
+	mPositions.Init(INDEX_NONE, numTiles);
+}
+
+void ATileGrid::FTileSet::Add(int32 tileIndex)
+{
+	if (mPositions[tileIndex] == INDEX_NONE)
+	{
+		mPositions[tileIndex] = mTileIndices.Add(tileIndex);
+	}
+}
+
+void ATileGrid::FTileSet::Remove(int32 tileIndex)
+{
+	const int32 position = mPositions[tileIndex];
+	if (position == INDEX_NONE)
+		return;
+
+	//The last tile is moved into its place
+	const int32 lastTileIndex = mTileIndices.Last();
+	mTileIndices[position] = lastTileIndex;
+	mPositions[lastTileIndex] = position;
+
+	mTileIndices.Pop(false);
+	mPositions[tileIndex] = INDEX_NONE;
+}
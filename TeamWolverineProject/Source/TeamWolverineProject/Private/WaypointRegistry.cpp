@@ -0,0 +1,263 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "WaypointRegistry.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+
+TMap<TWeakObjectPtr<UWorld>, TWeakObjectPtr<AWaypointRegistry>> AWaypointRegistry::sRegistries;
+
+AWaypointRegistry::AWaypointRegistry()
+	: mCellSize(1000.f)
+	, mMinCell(MAX_int32, MAX_int32)
+	, mMaxCell(MIN_int32, MIN_int32)
+{
+	PrimaryActorTick.bCanEverTick = false;
+}
+
+AWaypointRegistry* AWaypointRegistry::Get(UWorld* world)
+{
+	if (world == nullptr)
+		return nullptr;
+
+	if (AWaypointRegistry* registry = sRegistries.FindRef(world).Get())
+		return registry;
+
+	FActorSpawnParameters spawnInfo;
+	spawnInfo.ObjectFlags |= RF_Transient;
+
+	AWaypointRegistry* registry = world->SpawnActor<AWaypointRegistry>(spawnInfo);
+	if (registry == nullptr)
+		return nullptr;
+
+	registry->GatherWaypoints();
+	registry->mActorSpawnedHandle = world->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(registry, &AWaypointRegistry::OnActorSpawned));
+
+	sRegistries.Add(world, registry);
+	return registry;
+}
+
+void AWaypointRegistry::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UWorld* world = GetWorld())
+	{
+		world->RemoveOnActorSpawnedHandler(mActorSpawnedHandle);
+		sRegistries.Remove(world);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AWaypointRegistry::GatherWaypoints()
+{
+	for (TActorIterator<ATargetPoint> it(GetWorld()); it; ++it)
+	{
+		AddWaypoint(*it);
+	}
+}
+
+void AWaypointRegistry::OnActorSpawned(AActor* actor)
+{
+	if (ATargetPoint* waypoint = Cast<ATargetPoint>(actor))
+	{
+		AddWaypoint(waypoint);
+	}
+}
+
+void AWaypointRegistry::AddWaypoint(ATargetPoint* waypoint)
+{
+	//..No duplicate check, GatherWaypoints and OnActorSpawned see each target point once
+	if (waypoint == nullptr || waypoint->IsPendingKill())
+		return;
+
+	const int32 waypointIndex = mWaypoints.Add(waypoint);
+	mWaypointLocations.Add(waypoint->GetActorLocation());
+	mWaypointIndices.Add(waypoint, waypointIndex);
+
+	const FIntPoint cell = GetCell(mWaypointLocations[waypointIndex]);
+	mCellPositions.Add(mCells.FindOrAdd(cell).Add(waypointIndex));
+
+	mMinCell = FIntPoint(FMath::Min(mMinCell.X, cell.X), FMath::Min(mMinCell.Y, cell.Y));
+	mMaxCell = FIntPoint(FMath::Max(mMaxCell.X, cell.X), FMath::Max(mMaxCell.Y, cell.Y));
+
+	waypoint->OnDestroyed.AddUniqueDynamic(this, &AWaypointRegistry::RemoveWaypoint);
+}
+
+void AWaypointRegistry::RemoveWaypoint(AActor* waypoint)
+{
+	int32 waypointIndex = INDEX_NONE;
+	if (!mWaypointIndices.RemoveAndCopyValue(waypoint, waypointIndex))
+		return;
+
+	//The last waypoint of its cell is moved into its place in the cell
+	const FIntPoint cell = GetCell(mWaypointLocations[waypointIndex]);
+	TArray<int32>& cellWaypoints = mCells.FindChecked(cell);
+	const int32 cellPosition = mCellPositions[waypointIndex];
+	cellWaypoints.RemoveAtSwap(cellPosition, 1, false);
+
+	if (cellPosition < cellWaypoints.Num())
+	{
+		mCellPositions[cellWaypoints[cellPosition]] = cellPosition;
+	}
+	else if (cellWaypoints.Num() == 0)
+	{
+		mCells.Remove(cell);
+	}
+
+	//The last waypoint is moved into its place, so its cell entry and index have to follow
+	const int32 lastIndex = mWaypoints.Num() - 1;
+	if (waypointIndex != lastIndex)
+	{
+		mCells.FindChecked(GetCell(mWaypointLocations[lastIndex]))[mCellPositions[lastIndex]] = waypointIndex;
+		mWaypointIndices[mWaypoints[lastIndex]] = waypointIndex;
+	}
+
+	mWaypoints.RemoveAtSwap(waypointIndex, 1, false);
+	mWaypointLocations.RemoveAtSwap(waypointIndex, 1, false);
+	mCellPositions.RemoveAtSwap(waypointIndex, 1, false);
+
+	waypoint->OnDestroyed.RemoveDynamic(this, &AWaypointRegistry::RemoveWaypoint);
+}
+
+FIntPoint AWaypointRegistry::GetCell(const FVector& location) const
+{
+	return FIntPoint(FMath::FloorToInt(location.X / mCellSize), FMath::FloorToInt(location.Y / mCellSize));
+}
+
+ATargetPoint* AWaypointRegistry::GetRandomWaypoint(const FRandomStream& randomStream) const
+{
+	if (mWaypoints.Num() == 0)
+		return nullptr;
+
+	return mWaypoints[randomStream.RandRange(0, mWaypoints.Num() - 1)];
+}
+
+ATargetPoint* AWaypointRegistry::GetWeightedRandomWaypoint(const FVector& location, float radius, const FRandomStream& randomStream) const
+{
+	FMemMark memMark(FMemStack::Get());
+
+	TArray<int32, TMemStackAllocator<>> candidates;
+	TArray<float, TMemStackAllocator<>> weights;
+	float totalWeight = 0.f;
+
+	TArray<int32, TMemStackAllocator<>> indicesInRadius;
+	FindWaypointIndicesInRadius(location, radius, indicesInRadius);
+
+	for (const int32 waypointIndex : indicesInRadius)
+	{
+		const float distance = FVector::Dist2D(location, mWaypointLocations[waypointIndex]);
+		const float weight = 1.f - (distance / radius) + KINDA_SMALL_NUMBER;
+		candidates.Add(waypointIndex);
+		weights.Add(weight);
+		totalWeight += weight;
+	}
+
+	if (candidates.Num() == 0)
+		return nullptr;
+
+	float pick = randomStream.GetFraction() * totalWeight;
+	for (int32 candidate = 0; candidate < candidates.Num(); ++candidate)
+	{
+		pick -= weights[candidate];
+		if (pick <= 0.f)
+			return mWaypoints[candidates[candidate]];
+	}
+
+	return mWaypoints[candidates.Last()];
+}
+
+void AWaypointRegistry::FindNearestWaypoints(const FVector& location, int32 count, TArray<ATargetPoint*>& outWaypoints) const
+{
+	outWaypoints.Reset();
+
+	if (count <= 0 || mWaypoints.Num() == 0)
+		return;
+
+	typedef TPair<float, int32> FCandidate;
+	TArray<FCandidate, TInlineAllocator<32>> candidates;
+
+	const FIntPoint center = GetCell(location);
+	const int32 maxRing = FMath::Max(
+		FMath::Max(FMath::Abs(center.X - mMinCell.X), FMath::Abs(mMaxCell.X - center.X)),
+		FMath::Max(FMath::Abs(center.Y - mMinCell.Y), FMath::Abs(mMaxCell.Y - center.Y)));
+
+	//Visit rings of cells around the location's cell, everything outside ring n is at least n cells away.
+	for (int32 ring = 0; ring <= maxRing; ++ring)
+	{
+		for (int32 x = center.X - ring; x <= center.X + ring; ++x)
+		{
+			const bool isEdgeColumn = x == center.X - ring || x == center.X + ring;
+			const int32 yStep = isEdgeColumn ? 1 : FMath::Max(ring * 2, 1);
+
+			for (int32 y = center.Y - ring; y <= center.Y + ring; y += yStep)
+			{
+				if (const TArray<int32>* cell = mCells.Find(FIntPoint(x, y)))
+				{
+					for (const int32 waypointIndex : *cell)
+					{
+						candidates.Add(FCandidate(FVector::DistSquared2D(location, mWaypointLocations[waypointIndex]), waypointIndex));
+					}
+				}
+			}
+		}
+
+		if (candidates.Num() >= count)
+		{
+			candidates.Sort([](const FCandidate& a, const FCandidate& b) { return a.Key < b.Key; });
+
+			const float reachedDistance = ring * mCellSize;
+			if (candidates[count - 1].Key <= reachedDistance * reachedDistance)
+				break;
+		}
+	}
+
+	candidates.Sort([](const FCandidate& a, const FCandidate& b) { return a.Key < b.Key; });
+
+	const int32 numToReturn = FMath::Min(count, candidates.Num());
+	for (int32 candidate = 0; candidate < numToReturn; ++candidate)
+	{
+		outWaypoints.Add(mWaypoints[candidates[candidate].Value]);
+	}
+}
+
+void AWaypointRegistry::FindWaypointsInRadius(const FVector& location, float radius, TArray<ATargetPoint*>& outWaypoints) const
+{
+	FMemMark memMark(FMemStack::Get());
+
+	TArray<int32, TMemStackAllocator<>> indicesInRadius;
+	FindWaypointIndicesInRadius(location, radius, indicesInRadius);
+
+	outWaypoints.Reset(indicesInRadius.Num());
+	for (const int32 waypointIndex : indicesInRadius)
+	{
+		outWaypoints.Add(mWaypoints[waypointIndex]);
+	}
+}
+
+void AWaypointRegistry::FindWaypointIndicesInRadius(const FVector& location, float radius, TArray<int32, TMemStackAllocator<>>& outIndices) const
+{
+	outIndices.Reset();
+
+	if (radius <= 0.f || mWaypoints.Num() == 0)
+		return;
+
+	const FIntPoint minCell = GetCell(location - FVector(radius, radius, 0.f));
+	const FIntPoint maxCell = GetCell(location + FVector(radius, radius, 0.f));
+	const float radiusSquared = radius * radius;
+
+	for (int32 x = FMath::Max(minCell.X, mMinCell.X); x <= FMath::Min(maxCell.X, mMaxCell.X); ++x)
+	{
+		for (int32 y = FMath::Max(minCell.Y, mMinCell.Y); y <= FMath::Min(maxCell.Y, mMaxCell.Y); ++y)
+		{
+			if (const TArray<int32>* cell = mCells.Find(FIntPoint(x, y)))
+			{
+				for (const int32 waypointIndex : *cell)
+				{
+					if (FVector::DistSquared2D(location, mWaypointLocations[waypointIndex]) <= radiusSquared)
+					{
+						outIndices.Add(waypointIndex);
+					}
+				}
+			}
+		}
+	}
+}
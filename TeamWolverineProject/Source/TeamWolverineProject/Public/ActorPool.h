@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "GameFramework/Actor.h"
+
+#include "ActorPool.generated.h"
+
+UINTERFACE(meta = (CannotImplementInterfaceInBlueprint))
+class UPoolableActor : public UInterface
+{
+	GENERATED_BODY()
+};
+
+//Implemented by actors that need to reset their state when they are reused from a UActorPool.
+class IPoolableActor
+{
+	GENERATED_BODY()
+
+public:
+	//Called after the actor has been moved into place and shown again.
+	virtual void OnAcquiredFromPool() {}
+
+	//Called before the actor is hidden, should drop any state from its last use.
+	virtual void OnReturnedToPool() {}
+};
+
+USTRUCT()
+struct FPooledActors
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY()
+	TArray<AActor*> mActors;
+};
+
+/**
+ * Keeps actors that are no longer used, per class, hidden and without collision or ticking
+ * so they can be reused instead of going through a full spawn/destroy cycle.
+ */
+UCLASS()
+class TEAMWOLVERINEPROJECT_API UActorPool : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual UWorld* GetWorld() const override;
+
+	template<typename T>
+	T* Acquire(TSubclassOf<T> actorClass, const FTransform& transform) { return Cast<T>(AcquireActor(actorClass, transform)); }
+
+	//Reuses an inactive actor of the class if there is one, otherwise spawns a new one.
+	AActor* AcquireActor(UClass* actorClass, const FTransform& transform);
+	void Release(AActor* actor);
+
+	//Spawns actors up front until the class has count inactive actors.
+	void Prewarm(UClass* actorClass, int32 count);
+
+	int32 GetNumInactive(UClass* actorClass) const;
+
+private:
+	AActor* SpawnActor(UClass* actorClass, const FTransform& transform) const;
+	void Deactivate(AActor* actor) const;
+
+	UPROPERTY()
+	TMap<UClass*, FPooledActors> mInactiveActors;
+};
@@ -0,0 +1,146 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "EntityRegistry.h"
+#include "AnimalController.h"
+#include "FlowFieldNavigation.h"
+#include "AnimalCharacter.h"
+
+#include "AnimalBehaviorSystem.generated.h"
+
+class ATileGrid;
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnAnimalBehaviorEvent, AAnimalController*);
+
+/**
+ * Runs the Spawn/Traverse/Idle/Exit/Kill state machine for every animal controller in the world, so controllers don't tick.
+ * State is kept in arrays indexed the same as the registered controllers, idle timeouts wait in a heap ordered by deadline.
+ * Starting a traversal is what costs (it pathfinds), so traversals are queued and only started while the frame budget lasts.
+ * Each frame the animals are also sorted into significance tiers by distance to the camera and whether they're in view.
+ */
+UCLASS(NotPlaceable, Transient)
+class TEAMWOLVERINEPROJECT_API AAnimalBehaviorSystem : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AAnimalBehaviorSystem();
+
+	//Finds the system for the world, spawning it the first time.
+	static AAnimalBehaviorSystem* Get(UWorld* world);
+
+	virtual void Tick(float DeltaSeconds) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
+
+	FEntityHandle Register(AAnimalController* controller);
+	void Unregister(const FEntityHandle& animal);
+
+	void OnSpawn(const FEntityHandle& animal);
+	void OnTraverse(const FEntityHandle& animal);
+	void OnIdle(const FEntityHandle& animal);
+	void OnExit(const FEntityHandle& animal);
+	void OnMoveCompleted(const FEntityHandle& animal);
+
+	void SetState(const FEntityHandle& animal, EAnimalState newState);
+
+	//Back to how it was when it was registered, any pending idle timeout or traversal is dropped.
+	void ResetAnimal(const FEntityHandle& animal);
+
+	EAnimalState GetState(const FEntityHandle& animal) const;
+	EAnimalTransition GetTransition(const FEntityHandle& animal) const;
+
+	//At least one queued traversal is started every frame, however small the budget.
+	void SetFrameBudget(float budgetSeconds) { mFrameBudgetSeconds = budgetSeconds; }
+
+	void SetSignificanceSettings(const FAnimalSignificanceSettings& settings) { mSignificanceSettings = settings; }
+
+	//Animal decisions, e.g. which waypoint to head for, draw from this so they replay with the seed.
+	void SetRandomSeed(int32 seed) { mRandomStream.Initialize(seed); }
+	const FRandomStream& GetRandomStream() const { return mRandomStream; }
+
+	//The grid flow fields are built over, animals can't use flow fields until it's set.
+	void SetTileGrid(ATileGrid* tileGrid) { mFlowFields.SetTileGrid(tileGrid); }
+
+	//Steers the animal along the waypoint's flow field until it arrives, instead of pathfinding.
+	//Returns false if the waypoint can't be reached that way, so the caller can fall back to a regular move.
+	bool StartFlowFieldTraversal(const FEntityHandle& animal, const ATargetPoint* waypoint);
+
+	int32 Num() const { return mControllers.Num(); }
+
+	//Broadcast from Tick, not from where the state changed.
+	FOnAnimalBehaviorEvent OnAnimalExited;
+	FOnAnimalBehaviorEvent OnAnimalKilled;
+
+private:
+	struct FIdleTimer
+	{
+		double mDeadline;
+		FEntityHandle mAnimal;
+		uint32 mSerial;
+
+		bool operator<(const FIdleTimer& other) const { return mDeadline < other.mDeadline; }
+	};
+
+	struct FQueuedTraversal
+	{
+		FEntityHandle mAnimal;
+		uint32 mSerial;
+	};
+
+	void SetStateAtIndex(int32 index, EAnimalState newState);
+	void IdleAtIndex(int32 index);
+	void TraverseAtIndex(int32 index);
+	int32 GetCurrentIndex(const FEntityHandle& animal, uint32 serial) const;
+
+	void SteerFlowFieldAnimals();
+	void UpdateSignificance();
+	void ExpireIdleTimers();
+	void StartQueuedTraversals();
+	void BroadcastNotifications();
+	void DrawDebugOverlay() const;
+	void Compact();
+
+	TEntityRegistry<AAnimalController> mControllers;
+
+	//Indexed the same as mControllers.GetEntities()
+	TArray<EAnimalState> mStates;
+	TArray<EAnimalTransition> mTransitions;
+	TArray<uint8> mTraversalCounts;
+	TArray<uint8> mMaxTraversalCounts;
+	TArray<float> mIdleDurations;
+
+	//Flow field each animal is following, INDEX_NONE when it isn't
+	TArray<int32> mFlowFieldTargets;
+
+	//Significance tier last applied to each animal's character, with the top bit set if it was idle
+	TArray<uint8> mAppliedSignificances;
+	static constexpr uint8 SignificanceNotApplied = MAX_uint8;
+	static constexpr uint8 SignificanceIdleBit = 1 << 7;
+
+	//Bumped on every state change, so idle timers and queued traversals from an earlier state are skipped.
+	TArray<uint32> mSerials;
+
+	TArray<FIdleTimer> mIdleTimers;
+	TArray<FQueuedTraversal> mQueuedTraversals;
+	int32 mNextQueuedTraversal;
+
+	TArray<FEntityHandle> mExitedAnimals;
+	TArray<FEntityHandle> mKilledAnimals;
+
+	FFlowFieldNavigation mFlowFields;
+	float mFlowFieldAcceptanceRadius;
+
+	FAnimalSignificanceSettings mSignificanceSettings;
+
+	FRandomStream mRandomStream;
+
+	double mTime;
+	float mFrameBudgetSeconds;
+
+	static TMap<TWeakObjectPtr<UWorld>, TWeakObjectPtr<AAnimalBehaviorSystem>> sSystems;
+};
@@ -4,11 +4,53 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "Components/SkinnedMeshComponent.h"
 #include "GameData.h"
+#include "ActorPool.h"
+#include "EntityRegistry.h"
 #include "AnimalCharacter.generated.h"
 
+UENUM(BlueprintType)
+enum class EAnimalSignificance : uint8
+{
+	High,
+	Medium,
+	Low,
+	OffScreen,
+	MAX UMETA(Hidden)
+};
+
+USTRUCT(BlueprintType)
+struct FAnimalSignificanceSettings
+{
+	GENERATED_BODY()
+
+public:
+	FAnimalSignificanceSettings();
+
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Medium Distance", Tooltip = "Animals on screen further from the camera than this are Medium significance"))
+	float mMediumDistance;
+
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Low Distance", Tooltip = "Animals on screen further from the camera than this are Low significance"))
+	float mLowDistance;
+
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Medium Tick Interval", ClampMin = "0"))
+	float mMediumTickInterval;
+
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Low Tick Interval", ClampMin = "0"))
+	float mLowTickInterval;
+
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Off Screen Tick Interval", ClampMin = "0"))
+	float mOffScreenTickInterval;
+
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Frustum Margin", ClampMin = "0", Tooltip = "Degrees added to the camera's field of view so animals at the edge of the screen don't flicker between tiers"))
+	float mFrustumMarginDegrees;
+
+	float GetTickInterval(EAnimalSignificance significance) const;
+};
+
 UCLASS()
-class TEAMWOLVERINEPROJECT_API AAnimalCharacter : public ACharacter
+class TEAMWOLVERINEPROJECT_API AAnimalCharacter : public ACharacter, public IPoolableActor
 {
 	GENERATED_BODY()
 
@@ -22,14 +64,25 @@ public:
 	UFUNCTION(BlueprintCallable)
 	ESpawnTier GetSpawnTier() const { return mSpawnTier; }
 
+	//IPoolableActor
+	virtual void OnAcquiredFromPool() override;
+	virtual void OnReturnedToPool() override;
+
+	//Handle into the object manager's registry
+	const FEntityHandle& GetEntityHandle() const { return mEntityHandle; }
+	void SetEntityHandle(const FEntityHandle& handle) { mEntityHandle = handle; }
+
+	//Sets how often movement and animation update. Idle animals don't move, so only the closest keep simulating movement.
+	void ApplySignificance(EAnimalSignificance significance, bool isIdle, const FAnimalSignificanceSettings& settings);
+
+	UFUNCTION(BlueprintCallable)
+	EAnimalSignificance GetSignificance() const { return mSignificance; }
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
 public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
-
 	// Called to bind functionality to input
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 
@@ -41,4 +94,7 @@ public:
 
 private:
 	uint8 mStoppedTimer;
+	FEntityHandle mEntityHandle;
+	EAnimalSignificance mSignificance;
+	TEnumAsByte<EVisibilityBasedAnimTickOption::Type> mDefaultAnimTickOption;
 };
@@ -6,8 +6,12 @@
 #include "AIController.h"
 #include "Engine/TargetPoint.h"
 #include "Animation/AnimInstance.h"
+#include "WaypointRegistry.h"
+#include "EntityRegistry.h"
 #include "AnimalController.generated.h"
 
+class AAnimalBehaviorSystem;
+
 
 UENUM(BlueprintType)
 enum class EAnimalState : uint8
@@ -36,8 +40,10 @@ class TEAMWOLVERINEPROJECT_API AAnimalController : public AAIController
 	GENERATED_BODY()
 
 public:
+	AAnimalController();
+
 	void BeginPlay() override;
-	virtual void Tick(float DeltaSeconds) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	virtual void OnMoveCompleted(FAIRequestID RequestID, const FPathFollowingResult& Result) override;
 
@@ -56,13 +62,25 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void OnExit();
 
+	//Stops moving and goes back to the state it had before OnSpawn, for when its character is returned to the pool.
+	void ResetForReuse();
+
+	const FEntityHandle& GetBehaviorHandle() const { return mBehaviorHandle; }
+	uint8 GetMaxTraversalCount() const { return mMaxTraversalCount; }
+	float GetIdleDuration() const { return mIdleDuration; }
+
+	//The waypoint of the last traversal, which it may have arrived at already.
+	ATargetPoint* GetCurrentWaypoint() const { return mCurrentWaypoint.Get(); }
+
 	UFUNCTION(BlueprintCallable)
-	EAnimalState GetCurrentState() const { return mCurrentState; }
+	EAnimalState GetCurrentState() const;
 
 	UFUNCTION(BlueprintCallable)
-	EAnimalTransition GetAnimalTransition() const { return mCurrentTransition; }
+	EAnimalTransition GetAnimalTransition() const;
 
 private:
+	friend class AAnimalBehaviorSystem;
+
 	UFUNCTION(BlueprintCallable)
 	void GoToRandomWaypoint();
 
@@ -70,19 +88,24 @@ private:
 	ATargetPoint* GetRandomWaypoint();
 
 	UPROPERTY()
-	TArray<AActor*> mWaypoints;
-
-	UPROPERTY(EditAnywhere)
-	EAnimalState mCurrentState;
+	AWaypointRegistry* mWaypointRegistry;
 
-	UPROPERTY(EditAnywhere)
-	EAnimalTransition mCurrentTransition;
-
-	UPROPERTY()
-	uint8 mTraversalCount;
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Waypoint Search Radius", Tooltip = "Only pick waypoints this close, closer ones being more likely. 0 picks from every waypoint in the level"))
+	float mWaypointSearchRadius;
 
 	UPROPERTY(EditAnywhere, meta = (DisplayName = "Max Traversals"))
 	uint8 mMaxTraversalCount;
 
-	float mTimeSpentInIdle;
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Use Flow Field Navigation", Tooltip = "Steer along a flow field shared by every animal heading to the same waypoint instead of pathfinding on the navmesh"))
+	bool mUseFlowFieldNavigation;
+
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Idle Duration", ClampMin = "0", Tooltip = "Seconds spent idle at a waypoint before moving on"))
+	float mIdleDuration;
+
+	//State lives in the behavior system, the controller only keeps its handle into it.
+	UPROPERTY()
+	AAnimalBehaviorSystem* mBehaviorSystem;
+	FEntityHandle mBehaviorHandle;
+
+	TWeakObjectPtr<ATargetPoint> mCurrentWaypoint;
 };
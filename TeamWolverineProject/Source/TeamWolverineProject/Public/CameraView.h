@@ -0,0 +1,22 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UWorld;
+
+/** Where the local player is looking, for sorting actors into significance tiers. */
+struct FCameraView
+{
+	//Returns false if there is no player camera to look through.
+	bool InitFromFirstPlayer(const UWorld* world, float marginDegrees);
+
+	//The horizontal field of view (plus margin) as a cone, a bit generous vertically which is fine for picking a tier.
+	bool IsInView(const FVector& location) const { return FVector::DotProduct((location - mLocation).GetSafeNormal(), mDirection) >= mMinViewCosine; }
+	float GetDistanceSquared(const FVector& location) const { return FVector::DistSquared(location, mLocation); }
+
+	FVector mLocation = FVector::ZeroVector;
+	FVector mDirection = FVector::ForwardVector;
+	float mMinViewCosine = -1.f;
+};
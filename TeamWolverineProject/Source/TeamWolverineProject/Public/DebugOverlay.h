@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CameraView.h"
+#include "EngineDefines.h"
+
+class UWorld;
+
+//Bits of Fyri.DebugOverlay
+enum class EDebugOverlayLayer : int32
+{
+	Neighbors = 1 << 0,	//..Neighbors and what each plantable has interacted with
+	Growth = 1 << 1,	//..Growing stage and time left until the next one
+	Waypoints = 1 << 2	//..The waypoint each animal is heading for
+};
+
+#if ENABLE_DRAW_DEBUG
+
+/**
+ * Debug drawing switched on at runtime with Fyri.DebugOverlay, compiled out along with the rest of debug drawing.
+ * Only what is in view and close to the camera is drawn, and only up to Fyri.DebugOverlay.MaxDraws per frame across every layer,
+ * so turning it on doesn't hide the hitch that is being looked for.
+ */
+class TEAMWOLVERINEPROJECT_API FDebugOverlay
+{
+public:
+	static bool IsEnabled(EDebugOverlayLayer layer);
+
+	//Returns false if none of the layers are on, or there is no camera to cull against.
+	bool Begin(const UWorld* world, std::initializer_list<EDebugOverlayLayer> layers);
+
+	//In view, close enough and within this frame's budget. Counts as a draw if it returns true.
+	bool TryDrawAt(const FVector& location);
+
+private:
+	FCameraView mCameraView;
+	float mMaxDistanceSquared = 0.f;
+
+	static uint64 sBudgetFrame;
+	static int32 sNumDrawsThisFrame;
+};
+
+#endif
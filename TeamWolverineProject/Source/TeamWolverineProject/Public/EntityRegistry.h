@@ -0,0 +1,142 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/UObjectGlobals.h"
+
+/** Refers to an entity in a TEntityRegistry, and stops resolving once that entity is removed even if its slot is reused. */
+struct FEntityHandle
+{
+	bool IsSet() const { return mSlot != INDEX_NONE; }
+
+	bool operator==(const FEntityHandle& other) const { return mSlot == other.mSlot && mGeneration == other.mGeneration; }
+	bool operator!=(const FEntityHandle& other) const { return !(*this == other); }
+
+	int32 mSlot = INDEX_NONE;
+	uint32 mGeneration = 0;
+};
+
+/**
+ * Keeps managed entities packed in one array for iteration, and hands out generational handles to them.
+ * Removing only clears the entry so it's safe in the middle of iterating, the array is compacted with swap-removes on Flush.
+ * The owner has to report the entities to the GC through AddReferencedObjects.
+ */
+template<typename T>
+class TEntityRegistry
+{
+public:
+	FEntityHandle Add(T* entity)
+	{
+		int32 slotIndex;
+		if (mFreeSlots.Num() > 0)
+		{
+			slotIndex = mFreeSlots.Pop(false);
+		}
+		else
+		{
+			slotIndex = mSlots.AddDefaulted();
+		}
+
+		FSlot& slot = mSlots[slotIndex];
+		slot.mEntityIndex = mEntities.Add(entity);
+		mEntitySlots.Add(slotIndex);
+
+		FEntityHandle handle;
+		handle.mSlot = slotIndex;
+		handle.mGeneration = slot.mGeneration;
+		return handle;
+	}
+
+	//The handle stops resolving right away, the entity's entry is nulled until the next Flush.
+	void Remove(const FEntityHandle& handle)
+	{
+		if (!IsValid(handle))
+			return;
+
+		FSlot& slot = mSlots[handle.mSlot];
+
+		mEntities[slot.mEntityIndex] = nullptr;
+		mEntitySlots[slot.mEntityIndex] = INDEX_NONE;
+		mPendingRemovals.Add(slot.mEntityIndex);
+
+		++slot.mGeneration;
+		slot.mEntityIndex = INDEX_NONE;
+		mFreeSlots.Add(handle.mSlot);
+	}
+
+	void Flush()
+	{
+		Flush([](int32, int32) {});
+	}
+
+	//onEntityMoved(fromIndex, toIndex) is called for every entry moved to fill a hole, so arrays kept alongside can follow.
+	//Those arrays then have to be shrunk to GetEntities().Num().
+	template<typename FuncType>
+	void Flush(FuncType onEntityMoved)
+	{
+		if (mPendingRemovals.Num() == 0)
+			return;
+
+		//Going from the back means every entry moved into a hole is one that is still alive.
+		mPendingRemovals.Sort(TGreater<int32>());
+
+		for (const int32 entityIndex : mPendingRemovals)
+		{
+			const int32 lastIndex = mEntities.Num() - 1;
+			if (entityIndex != lastIndex)
+			{
+				mEntities[entityIndex] = mEntities[lastIndex];
+				mEntitySlots[entityIndex] = mEntitySlots[lastIndex];
+
+				if (mEntitySlots[entityIndex] != INDEX_NONE)
+				{
+					mSlots[mEntitySlots[entityIndex]].mEntityIndex = entityIndex;
+				}
+
+				onEntityMoved(lastIndex, entityIndex);
+			}
+
+			mEntities.Pop(false);
+			mEntitySlots.Pop(false);
+		}
+
+		mPendingRemovals.Reset();
+	}
+
+	bool IsValid(const FEntityHandle& handle) const
+	{
+		return mSlots.IsValidIndex(handle.mSlot) && mSlots[handle.mSlot].mGeneration == handle.mGeneration && mSlots[handle.mSlot].mEntityIndex != INDEX_NONE;
+	}
+
+	T* Get(const FEntityHandle& handle) const { return IsValid(handle) ? mEntities[mSlots[handle.mSlot].mEntityIndex] : nullptr; }
+
+	//Index into GetEntities(), only stable until the next Flush.
+	int32 GetIndex(const FEntityHandle& handle) const { return IsValid(handle) ? mSlots[handle.mSlot].mEntityIndex : INDEX_NONE; }
+
+	//Entries are nullptr for entities removed since the last Flush.
+	const TArray<T*>& GetEntities() const { return mEntities; }
+
+	int32 Num() const { return mEntities.Num() - mPendingRemovals.Num(); }
+
+	void AddReferencedObjects(FReferenceCollector& collector, const UObject* referencingObject)
+	{
+		collector.AddReferencedObjects(mEntities, referencingObject);
+	}
+
+private:
+	struct FSlot
+	{
+		int32 mEntityIndex = INDEX_NONE;
+		uint32 mGeneration = 0;
+	};
+
+	TArray<T*> mEntities;
+
+	//The slot of each entry in mEntities, to fix up its handle when it's moved
+	TArray<int32> mEntitySlots;
+
+	TArray<FSlot> mSlots;
+	TArray<int32> mFreeSlots;
+	TArray<int32> mPendingRemovals;
+};
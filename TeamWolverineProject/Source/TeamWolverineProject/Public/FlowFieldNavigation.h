@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class ATileGrid;
+class ATargetPoint;
+
+/**
+ * One flow field per waypoint over the traversable tiles, so any number of animals heading to the same waypoint share one search.
+ * Each field stores, per tile, the number of steps to the waypoint's tile and the tile to step to next.
+ * Fields are built the first time a waypoint is asked for, and repaired (not rebuilt) when a tile's traversability changes.
+ */
+class TEAMWOLVERINEPROJECT_API FFlowFieldNavigation
+{
+public:
+	FFlowFieldNavigation();
+	~FFlowFieldNavigation();
+
+	//Fields already built are rebuilt against the new grid, keeping their indices.
+	void SetTileGrid(ATileGrid* tileGrid);
+	bool HasTileGrid() const { return mTileGrid.IsValid(); }
+
+	//Returns INDEX_NONE if there is no grid or the waypoint isn't on it.
+	int32 FindOrBuildField(const ATargetPoint* waypoint);
+
+	bool IsReachable(int32 fieldIndex, const FVector& location) const;
+
+	//Returns false once the location has arrived at the waypoint, or if the waypoint can't be reached from it.
+	bool GetSteeringDirection(int32 fieldIndex, const FVector& location, float acceptanceRadius, FVector& outDirection) const;
+
+	int32 Num() const { return mFields.Num(); }
+
+private:
+	//32 bit, a winding path on a large grid can be more steps than 16 bits hold. A path is at most one step per tile.
+	static constexpr uint32 Unreachable = MAX_uint32;
+
+	struct FFlowField
+	{
+		FVector mGoalLocation;
+		int32 mGoalTile;
+		TArray<uint32> mDistances;
+		TArray<int32> mNextTiles;
+	};
+
+	struct FFrontierTile
+	{
+		uint32 mDistance;
+		int32 mTileIndex;
+
+		bool operator<(const FFrontierTile& other) const { return mDistance < other.mDistance; }
+	};
+
+	void Build(FFlowField& field) const;
+	void RebuildAll();
+	void Propagate(FFlowField& field, TArray<FFrontierTile>& frontier) const;
+	void PushReachableNeighbors(const FFlowField& field, int32 tileIndex, TArray<FFrontierTile>& frontier) const;
+
+	void OnTraversabilityChanged(int32 tileIndex, bool isTraversable);
+	void OnTileBlocked(FFlowField& field, int32 tileIndex);
+	void OnTileUnblocked(FFlowField& field, int32 tileIndex);
+	void OnGridRebuilt();
+
+	TWeakObjectPtr<ATileGrid> mTileGrid;
+	FDelegateHandle mTraversabilityChangedHandle;
+	FDelegateHandle mGridRebuiltHandle;
+
+	TArray<FFlowField> mFields;
+	TMap<TWeakObjectPtr<const ATargetPoint>, int32> mFieldIndices;
+};
@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+/**
+ * "stat Fyri" shows where gameplay time goes, and the scopes show up as named events in profilers with "stat namedevents".
+ * Everything here compiles out along with the rest of the stats system (e.g. in shipping).
+ */
+DECLARE_STATS_GROUP(TEXT("Fyri"), STATGROUP_Fyri, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Object Manager Tick"), STAT_ObjectManagerTick, STATGROUP_Fyri, TEAMWOLVERINEPROJECT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Plant Significance"), STAT_PlantSignificance, STATGROUP_Fyri, TEAMWOLVERINEPROJECT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Plantable Growth"), STAT_PlantableGrowth, STATGROUP_Fyri, TEAMWOLVERINEPROJECT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Plantable Grow"), STAT_PlantableGrow, STATGROUP_Fyri, TEAMWOLVERINEPROJECT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Interaction Evaluation"), STAT_InteractionEvaluation, STATGROUP_Fyri, TEAMWOLVERINEPROJECT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Neighbors"), STAT_FindNeighbors, STATGROUP_Fyri, TEAMWOLVERINEPROJECT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Spawn Object"), STAT_SpawnObject, STATGROUP_Fyri, TEAMWOLVERINEPROJECT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Spawn Animal"), STAT_SpawnAnimal, STATGROUP_Fyri, TEAMWOLVERINEPROJECT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Animal Behavior Tick"), STAT_AnimalBehaviorTick, STATGROUP_Fyri, TEAMWOLVERINEPROJECT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Animal State Transition"), STAT_AnimalStateTransition, STATGROUP_Fyri, TEAMWOLVERINEPROJECT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Start Animal Traversals"), STAT_StartAnimalTraversals, STATGROUP_Fyri, TEAMWOLVERINEPROJECT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Animal Significance"), STAT_AnimalSignificance, STATGROUP_Fyri, TEAMWOLVERINEPROJECT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Flow Field Steering"), STAT_FlowFieldSteering, STATGROUP_Fyri, TEAMWOLVERINEPROJECT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Flow Field Build"), STAT_FlowFieldBuild, STATGROUP_Fyri, TEAMWOLVERINEPROJECT_API);
+
+//Live totals
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Plantables"), STAT_NumPlantables, STATGROUP_Fyri, TEAMWOLVERINEPROJECT_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Animals"), STAT_NumAnimals, STATGROUP_Fyri, TEAMWOLVERINEPROJECT_API);
+
+//Per frame
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Interactions Evaluated"), STAT_InteractionsEvaluated, STATGROUP_Fyri, TEAMWOLVERINEPROJECT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Interactions Fired"), STAT_InteractionsFired, STATGROUP_Fyri, TEAMWOLVERINEPROJECT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Blueprint Events"), STAT_BlueprintEvents, STATGROUP_Fyri, TEAMWOLVERINEPROJECT_API);
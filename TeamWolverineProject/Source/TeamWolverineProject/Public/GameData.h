@@ -12,7 +12,9 @@ enum class ETileType : uint8
 {
 	Grass,
 	Water,
-	Stone
+	Stone,
+
+	MAX UMETA(Hidden)
 };
 
 UENUM(BlueprintType)
@@ -20,7 +22,9 @@ enum class EPlantableObjectType : uint8
 {
 	Plant,
 	Food,
-	Tree
+	Tree,
+
+	MAX UMETA(Hidden)
 };
 
 UENUM(BlueprintType)
@@ -39,7 +43,9 @@ enum class ENeighborLocationType : uint8
 	Left,
 	Right,
 	Up,
-	Down
+	Down,
+
+	MAX
 };
 
 UENUM(BlueprintType)
@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+class APlantableObject;
+
+/**
+ * Timer wheel that tells the object manager when plantables are due to grow, so plantables don't have to tick.
+ * Timers are hashed into slots by their deadline tick, and advancing only visits the slots for the ticks that passed.
+ * Timers further away than one revolution of the wheel stay in their slot until their deadline comes around.
+ */
+class TEAMWOLVERINEPROJECT_API FGrowthScheduler
+{
+public:
+	explicit FGrowthScheduler(float tickInterval = 0.1f);
+
+	struct FDueObject
+	{
+		APlantableObject* mObject;
+		uint32 mSerial;
+	};
+
+	//Replaces any timer the object already has.
+	void Schedule(APlantableObject* object, float delaySeconds);
+	void Cancel(APlantableObject* object);
+
+	//Moves time forward and adds every object whose timer ran out to outDueObjects.
+	void Advance(float deltaSeconds, TArray<FDueObject>& outDueObjects);
+
+	//False once the object was cancelled or rescheduled after coming due, e.g. removed by an earlier object's grow event.
+	static bool IsStillDue(const FDueObject& dueObject);
+
+	double GetTime() const { return mTime; }
+
+private:
+	static constexpr uint32 NumSlots = 256;
+
+	struct FTimer
+	{
+		//Weak, the object may be destroyed without being cancelled (e.g. level unload)
+		TWeakObjectPtr<APlantableObject> mObject;
+		uint32 mSerial;
+		uint64 mDeadlineTick;
+	};
+
+	void CollectDueTimers(TArray<FTimer>& slot, uint64 dueTick, TArray<FDueObject>& outDueObjects);
+	bool IsStale(const FTimer& timer) const;
+
+	TArray<FTimer> mSlots[NumSlots];
+
+	double mTime;
+	uint64 mCurrentTick;
+	float mTickInterval;
+};
@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameData.h"
+
+class UObjectInteraction;
+
+/**
+ * Interaction ids for every plantable + plantable and plantable + terrain pair, compiled from the
+ * UObjectInteraction assets so that finding the interaction for a pair is a single lookup.
+ * Ids are indices into the compiled interaction list, in the order the assets were listed.
+ */
+class TEAMWOLVERINEPROJECT_API FInteractionTable
+{
+public:
+	static constexpr int16 NoInteraction = INDEX_NONE;
+
+	FInteractionTable();
+
+	void Build(const TArray<UObjectInteraction*>& interactions);
+
+	int16 GetPlantableInteraction(EPlantableObjectType objectType, EPlantableObjectType neighborType) const { return mPlantableInteractions[static_cast<uint8>(objectType)][static_cast<uint8>(neighborType)]; }
+	int16 GetTerrainInteraction(EPlantableObjectType objectType, ETileType tileType) const { return mTerrainInteractions[static_cast<uint8>(objectType)][static_cast<uint8>(tileType)]; }
+
+	UObjectInteraction* GetInteraction(int16 interactionId) const { return mInteractions[interactionId]; }
+	const FString& GetInteractionName(int16 interactionId) const { return mInteractionNames[interactionId]; }
+	int16 FindInteractionId(const UObjectInteraction* interaction) const;
+	const TArray<UObjectInteraction*>& GetInteractions() const { return mInteractions; }
+	int32 Num() const { return mInteractions.Num(); }
+
+private:
+	static constexpr uint8 NumPlantableObjectTypes = static_cast<uint8>(EPlantableObjectType::MAX);
+	static constexpr uint8 NumTileTypes = static_cast<uint8>(ETileType::MAX);
+
+	bool TryAssign(int16& entry, int16 interactionId, const TCHAR* interactionName);
+	void Reset();
+
+	int16 mPlantableInteractions[NumPlantableObjectTypes][NumPlantableObjectTypes];
+	int16 mTerrainInteractions[NumPlantableObjectTypes][NumTileTypes];
+
+	TArray<UObjectInteraction*> mInteractions;
+	TArray<FString> mInteractionNames;
+	TMap<const UObjectInteraction*, int16> mInteractionIds;
+};
@@ -10,12 +10,21 @@
 #include "GameData.h"
 #include "AnimalController.h"
 #include "AnimalCharacter.h"
+#include "InteractionTable.h"
+#include "GrowthScheduler.h"
+#include "PlantableInstancer.h"
+#include "ActorPool.h"
+#include "EntityRegistry.h"
+#include "SpawnTierSampler.h"
+#include "WorldCollision.h"
 #include "ObjectManager.generated.h"
 
 class ATile;
+class ATileGrid;
 class APlantableObject;
 class UAnimInstance;
 class UParticleSystem;
+class AAnimalBehaviorSystem;
 
 
 USTRUCT(BlueprintType)
@@ -117,6 +126,8 @@ public:
 
 	UPROPERTY(EditAnywhere, meta = (DisplayName = "Edible Probabilities"))
 	FSpawnTierProbabilities mEdibleProbabilities;
+
+	const FSpawnTierProbabilities& GetProbabilities(EPlantableObjectType objectType) const;
 };
 
 UCLASS()
@@ -134,6 +145,8 @@ public:
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (DisplayName = "Mythical Plantable Inventory"))
 	TArray<TSubclassOf<APlantableObject>> mMythicalObjectInventory;
+
+	const TArray<TSubclassOf<APlantableObject>>& GetTierInventory(ESpawnTier tier) const;
 };
 
 UCLASS()
@@ -151,6 +164,8 @@ public:
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (DisplayName = "Edible Inventory"))
 	UPlantableInventory* mEdibleInventory;
+
+	const UPlantableInventory* GetInventory(EPlantableObjectType objectType) const;
 };
 
 UCLASS(meta=(BlueprintSpawnableComponent))
@@ -162,8 +177,11 @@ public:
 	~AObjectManagerComponent();
 
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void Tick(float DeltaSeconds) override;
 
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
+
 
 	UFUNCTION(BlueprintImplementableEvent, Category = "Interaction")
 	void OnInteractionStart(UInteractionResult* interactionResult, const FVector& interactionLocation, const FString& interactionName);
@@ -174,21 +192,48 @@ public:
 	UFUNCTION(BlueprintImplementableEvent, Category = "Spawn")
 	void OnObjectSpawned(APlantableObject* spawnedObject);
 
+	UFUNCTION(BlueprintImplementableEvent, Category = "Spawn", meta = (Tooltip = "While hover preview is on, when the tile under the cursor or whether an object can be spawned on it changes. For the placement ghost"))
+	void OnHoverTileChanged(bool hasTile, const FVector& tileLocation, bool canSpawn);
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "Spawn", meta = (Tooltip = "Fired once per SpawnObjectsAtTiles/SpawnObjectsInArea instead of OnObjectSpawned for each object"))
+	void OnObjectsSpawned(const TArray<APlantableObject*>& spawnedObjects);
+
 	UFUNCTION(BlueprintImplementableEvent, Category = "Spawn")
 	void OnAnimalSpawned(ACharacter* spawnedObject);
 
+	UFUNCTION(BlueprintImplementableEvent, Category = "Spawn")
+	void OnAnimalExited(ACharacter* exitedAnimal);
+
 	UFUNCTION(BlueprintImplementableEvent, Category = "Spawn")
 	void OnDiscoveredObject();
 
-	UFUNCTION(BlueprintCallable)
+	UFUNCTION(BlueprintCallable, meta = (Tooltip = "For levels made of tile actors. Builds a tile grid from them, destroying the actors, and inits with it"))
 	void Init(TArray<ATile*> tiles);
 
 	UFUNCTION(BlueprintCallable)
+	void InitWithTileGrid(ATileGrid* tileGrid);
+
+	UFUNCTION(BlueprintCallable, meta = (Tooltip = "Spawns right away if the per-frame animal spawn budget allows it, otherwise on a later frame"))
 	void SpawnAnimal(TSubclassOf<AAnimalCharacter> animal);
 
-	UFUNCTION(BlueprintCallable, Category = "Spawn")
+	UFUNCTION(BlueprintCallable, Category = "Spawn", meta = (Tooltip = "Spawns on the tile under the cursor, the hover tile if hover preview is on"))
 	void SpawnObject();
 
+	UFUNCTION(BlueprintCallable, Category = "Spawn", meta = (Tooltip = "Traces for the tile under the cursor every frame, asynchronously, and reports it through OnHoverTileChanged"))
+	void SetHoverPreviewEnabled(bool isEnabled);
+
+	//Returns nullptr if the tile isn't traversable or already has an object on it.
+	APlantableObject* SpawnObjectAtTile(TSubclassOf<APlantableObject> objectClass, int32 tileIndex);
+
+	UFUNCTION(BlueprintCallable, Category = "Spawn", meta = (Tooltip = "Plants an object of the selected type on every free tile, placing them all before linking neighbors. Fires OnObjectsSpawned once. Tiles that are taken are skipped"))
+	TArray<APlantableObject*> SpawnObjectsAtTiles(const TArray<int32>& tileIndices);
+
+	UFUNCTION(BlueprintCallable, Category = "Spawn", meta = (Tooltip = "SpawnObjectsAtTiles on the tiles within the radius of the center"))
+	TArray<APlantableObject*> SpawnObjectsInArea(const FVector& center, float radius);
+
+	UFUNCTION(BlueprintCallable, Category = "Spawn", meta = (Tooltip = "Takes the object off its tile and returns it to the pool"))
+	void RemoveObject(APlantableObject* object);
+
 	UFUNCTION(BlueprintCallable)
 	void UpdateCurrentlySelectedPlantableObject(EPlantableObjectType objectType);
 
@@ -198,6 +243,17 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Spawn Probability", meta = (Tooltip = "Will check if has reached the required amount on this interaction"))
 	bool HasReachedRequiredInteractionAmount(UObjectInteraction* interaction, EGrowingStage mCurrentObjectsGrowingStage) const;
 
+	UFUNCTION(BlueprintCallable, Category = "Interaction", meta = (Tooltip = "How many times this interaction has happened since it was last restarted"))
+	int32 GetInteractionAmount(UObjectInteraction* interaction) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Growth", meta = (Tooltip = "Grows every plantable as if this many seconds had passed, e.g. for progress while the game was closed"))
+	void AdvanceTime(float seconds, bool coalesceGrowEvents = true);
+
+	void AdvanceObjectTime(APlantableObject* object, float seconds, bool coalesceGrowEvents);
+
+	//Queues the object to have its interactions evaluated next tick, call whenever its neighbors, tile or growing stage change.
+	void QueueInteractionUpdate(APlantableObject* object);
+
 	UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "Discovered Objects"))
 	TSet<int32> mDiscoveredTypes;
 
@@ -205,36 +261,128 @@ public:
 	TMap<FString, UTexture2D*> mJournalPageMappings;
 
 private:
-	void GatherObjectIfIsNeighbor(TMap<ENeighborLocationType, TTuple<APlantableObject*, float>>& objects, APlantableObject* objectToCheckWith, const FVector& objectsDirection, const float distanceToObject) const;
-	void DebugRenderObject(APlantableObject* objectToRender) const;
-
-	const TMap<ENeighborLocationType, APlantableObject*> FindNeighborsForObject(APlantableObject* spawnedObject) const;
-	FVector GetDirectionFromLocationType(ENeighborLocationType locationType) const;
+	friend class UObjectManagerBenchmarkCommandlet;
+
+	void DrawDebugOverlay() const;
+	void EvaluateInteractionsForObject(APlantableObject* object);
+	void OnInteractionSucceeded(int16 interactionId, APlantableObject* object);
+	bool HasReachedRequiredInteractionAmount(int16 interactionId) const;
+	void ScheduleGrowth(APlantableObject* object);
+	void UpdatePlantSignificance();
+	void PutToSleep(APlantableObject* object);
+	void WakeUp(APlantableObject* object);
+	void RescheduleGrowth(APlantableObject* object);
+	void UpdateHoverPreview();
+	void OnHoverTraceDone(const FTraceHandle& traceHandle, FTraceDatum& traceDatum);
+	void SetHoverTile(int32 tileIndex);
+	//Takes the object from the pool and puts it on the tile, without linking it to its neighbors or firing any events.
+	APlantableObject* PlaceObjectAtTile(TSubclassOf<APlantableObject> objectClass, int32 tileIndex);
+	void SpawnAnimalNow(TSubclassOf<AAnimalCharacter> animal);
+	void SpawnPendingAnimals();
+	void PrewarmActorPool();
+	void HandleAnimalExited(AAnimalController* controller);
+	void HandleAnimalKilled(AAnimalController* controller);
+
+	FPlantableNeighbors FindNeighborsForObject(int32 tileIndex) const;
 	TSubclassOf<APlantableObject> GetObjectClassToSpawn() const;
+	void BuildSpawnTierSampler(EPlantableObjectType objectType);
+	void InitRandomStreams();
 
 	UPROPERTY(EditAnywhere, meta = (DisplayName = "Object Interactions"))
 	TArray<UObjectInteraction*> mObjectInteractions;
 
+	FInteractionTable mInteractionTable;
+
 	UPROPERTY(EditAnywhere, meta = (DisplayName = "Object Inventory"))
 	UGameObjectInventory* mObjectInventory;
 
 	UPROPERTY(EditAnywhere, meta = (DisplayName = "Game Spawn Probabilities"))
 	FGameSpawnProbabilities mSpawnProbabilities;
 
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Random Seed", Tooltip = "Seeds spawning, placement and animal decisions so a session can be replayed. -FyriSeed=<seed> on the command line overrides it, 0 picks a new seed every session"))
+	int32 mRandomSeed;
+
+	//A stream per subsystem, so e.g. an extra animal spawning doesn't change which plantables come up
+	FRandomStream mSpawnRandomStream;		//..Which plantable to spawn
+	FRandomStream mPlacementRandomStream;	//..Rotation and scale of plantables, where animals spawn
+
+	//Built from mSpawnProbabilities, indexed by EPlantableObjectType
+	FSpawnTierSampler mSpawnTierSamplers[static_cast<uint8>(EPlantableObjectType::MAX)];
+
 	UPROPERTY(EditAnywhere, meta = (DisplayName = "Animal Inventory"))
 	TArray<TSubclassOf<AAnimalCharacter>> mAnimalInventory;
 
-	struct FPlantedAmountData
-	{
-		uint8 mCurrentAmountPlanted = 0;
-		bool mHasCompletedInteraction = false;
-	};
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Use Instanced Plantables", Tooltip = "Draw plantables showing the same mesh as instances. Instanced plantables have no collision"))
+	bool mUseInstancedPlantables;
+
+	UPROPERTY()
+	UPlantableInstancer* mPlantableInstancer;
+
+	UPROPERTY(EditAnywhere, Category = "Pooling", meta = (DisplayName = "Prewarmed Animals Per Class", ClampMin = "0"))
+	int32 mPrewarmedAnimalsPerClass;
+
+	UPROPERTY(EditAnywhere, Category = "Pooling", meta = (DisplayName = "Prewarmed Plantables Per Class", ClampMin = "0"))
+	int32 mPrewarmedPlantablesPerClass;
+
+	UPROPERTY(EditAnywhere, Category = "Pooling", meta = (DisplayName = "Max Animal Spawns Per Frame", ClampMin = "1", Tooltip = "Animals requested past this in one frame are spawned on the following frames"))
+	int32 mMaxAnimalSpawnsPerFrame;
+
+	UPROPERTY()
+	UActorPool* mActorPool;
+
+	UPROPERTY()
+	TArray<TSubclassOf<AAnimalCharacter>> mPendingAnimalSpawns;
+	int32 mAnimalSpawnsThisFrame;
+
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Animal Behavior Budget (ms)", ClampMin = "0", Tooltip = "Time per frame for starting animal traversals, the rest wait for the next frame"))
+	float mAnimalBehaviorBudgetMs;
+
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Animal Significance"))
+	FAnimalSignificanceSettings mAnimalSignificanceSettings;
+
+	UPROPERTY()
+	AAnimalBehaviorSystem* mAnimalBehaviorSystem;
 
-	TMap<FString, FPlantedAmountData> mPlantedAmounts;
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Plant Significance"))
+	FPlantSignificanceSettings mPlantSignificanceSettings;
 
-	TArray<ATile*> mTiles;
-	TArray<APlantableObject*> mObjects;
-	TArray<AAnimalCharacter*> mAnimals;
+	//Where the round-robin significance update picks up next frame
+	int32 mNextPlantSignificanceIndex;
+
+	//Indexed by the interaction id from mInteractionTable
+	TArray<int32> mInteractionAmounts;
+
+	UPROPERTY()
+	ATileGrid* mTileGrid;
+
+	//Reported to the GC in AddReferencedObjects
+	TEntityRegistry<APlantableObject> mObjects;
+
+	//The plantable on each tile, indexed the same way as the tile grid
+	TArray<APlantableObject*> mObjectGrid;
+
+	//Removing an object leaves it in these, entries whose object is no longer queued are skipped.
+	//Reported in AddReferencedObjects.
+	TArray<APlantableObject*> mDirtyObjects;
+	TArray<APlantableObject*> mObjectsBeingEvaluated;
+
+	//Dirty dormant objects, evaluated every mDormantEvaluationInterval instead of every frame
+	TArray<APlantableObject*> mDormantDirtyObjects;
+	float mTimeUntilDormantEvaluation;
+
+	FGrowthScheduler mGrowthScheduler;
+	TArray<FGrowthScheduler::FDueObject> mObjectsToGrow;
+	TEntityRegistry<AAnimalCharacter> mAnimals;
 
 	EPlantableObjectType mCurrentlySelectedPlantableObject;
+
+	UPROPERTY(EditAnywhere, Category = "Spawn", meta = (DisplayName = "Hover Preview", Tooltip = "Trace for the tile under the cursor every frame, see OnHoverTileChanged"))
+	bool mIsHoverPreviewEnabled;
+
+	//The tile under the cursor as of the last finished trace, INDEX_NONE if there is none
+	int32 mHoverTileIndex;
+	bool mCanSpawnAtHoverTile;
+
+	FTraceDelegate mHoverTraceDelegate;
+	FTraceHandle mHoverTraceHandle;
 };
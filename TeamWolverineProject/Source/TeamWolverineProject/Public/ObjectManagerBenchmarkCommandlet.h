@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+
+#include "ObjectManagerBenchmarkCommandlet.generated.h"
+
+class AObjectManagerComponent;
+
+/**
+ * Times the object manager's hot paths headless, in a world of its own with a synthetic tile grid.
+ * For every object count it plants that many objects with a fixed seed, runs the manager for a number of ticks
+ * and writes calls, total/average/max time and memory growth per call for each function, as CSV or JSON (by the output's extension).
+ *
+ * UE4Editor-Cmd TeamWolverineProject -run=ObjectManagerBenchmark -nullrhi -unattended -Counts=100,1000,10000,100000 -Ticks=300
+ * Optional: -Seed=1234 -Output=<path> -Manager=<object manager class path>, to plant and spawn from a configured manager's inventories.
+ */
+UCLASS()
+class TEAMWOLVERINEPROJECT_API UObjectManagerBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UObjectManagerBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	struct FBenchmarkResult
+	{
+		int32 mNumObjects = 0;
+		FString mFunction;
+		int32 mCalls = 0;
+		double mTotalSeconds = 0.0;
+		double mMaxSeconds = 0.0;
+		int64 mMemoryGrowthBytes = 0;
+	};
+
+	void RunBenchmark(UClass* managerClass, int32 numObjects, int32 numTicks, int32 seed, TArray<FBenchmarkResult>& outResults) const;
+
+	static FString ToCsv(const TArray<FBenchmarkResult>& results);
+	static FString ToJson(const TArray<FBenchmarkResult>& results);
+};
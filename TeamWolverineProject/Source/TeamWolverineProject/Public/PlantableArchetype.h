@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "GameData.h"
+
+#include "PlantableArchetype.generated.h"
+
+class UStaticMesh;
+
+//Data shared by every plantable of a class, so it isn't copied into each spawned plant.
+UCLASS()
+class TEAMWOLVERINEPROJECT_API UPlantableArchetype : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPlantableArchetype();
+
+	UStaticMesh* GetStageMesh(EGrowingStage stage) const { return mStageMeshes[static_cast<uint8>(stage)]; }
+	bool HasAnyStageMesh() const;
+	float GetStageDuration(EGrowingStage stage) const;
+
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Journal Index"))
+	int32 mIndex;
+
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Spawn Tier"))
+	ESpawnTier mSpawnTier;
+
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Object Type"))
+	EPlantableObjectType mObjectType;
+
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Stage Meshes", Tooltip = "The meshes that will be used for the different stages", ArraySizeEnum = "EGrowingStage"))
+	UStaticMesh* mStageMeshes[(uint8)EGrowingStage::MAX];
+
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Time Until Next Growing Stage", Tooltip = "How much time it should take to get to the next growing stage, in seconds"))
+	float mTimeUntilNextGrowingStage;
+
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Stage Durations", Tooltip = "How much time to spend in each stage before growing, in seconds. Stages left at 0 use Time Until Next Growing Stage", ArraySizeEnum = "EGrowingStage"))
+	float mStageDurations[(uint8)EGrowingStage::MAX];
+};
@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SceneComponent.h"
+
+#include "PlantableInstancer.generated.h"
+
+class UStaticMesh;
+class UHierarchicalInstancedStaticMeshComponent;
+
+//Where a plantable's instance lives in a UPlantableInstancer.
+struct FPlantableInstanceHandle
+{
+	int32 mComponentIndex = INDEX_NONE;
+	int32 mInstanceIndex = INDEX_NONE;
+
+	bool IsValid() const { return mComponentIndex != INDEX_NONE; }
+};
+
+/**
+ * Renders plantables as instances, with one instanced mesh component per growing stage mesh,
+ * so every plant showing the same mesh is drawn together instead of as its own actor.
+ * Instances that are no longer used are hidden and reused, so instance indices never move.
+ */
+UCLASS()
+class TEAMWOLVERINEPROJECT_API UPlantableInstancer : public USceneComponent
+{
+	GENERATED_BODY()
+
+public:
+	UPlantableInstancer();
+
+	//Shows the instance with this mesh, moving it from the mesh it had before if any.
+	void SetInstanceMesh(FPlantableInstanceHandle& handle, UStaticMesh* mesh, const FTransform& worldTransform);
+	void RemoveInstance(FPlantableInstanceHandle& handle);
+
+	//Instance changes don't update the render state right away, call this once all changes for the frame are made.
+	void FlushRenderState();
+
+private:
+	int32 GetOrCreateComponent(UStaticMesh* mesh);
+
+	UPROPERTY(Transient)
+	TArray<UHierarchicalInstancedStaticMeshComponent*> mComponents;
+
+	TMap<UStaticMesh*, int32> mComponentIndices;
+	TArray<TArray<int32>> mFreeInstances;
+	TBitArray<> mDirtyComponents;
+};
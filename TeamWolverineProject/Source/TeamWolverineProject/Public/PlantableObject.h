@@ -4,42 +4,144 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "EngineDefines.h"
 #include "GameData.h"
+#include "PlantableInstancer.h"
+#include "PlantableArchetype.h"
+#include "ActorPool.h"
+#include "EntityRegistry.h"
 
 #include "PlantableObject.generated.h"
 
-class ATile;
+class ATileGrid;
 class UStaticMesh;
+class UStaticMeshComponent;
+class APlantableObject;
+class AObjectManagerComponent;
+
+/** Fixed Left/Right/Up/Down neighbor slots, plus a bit per slot for whether we have interacted with it. */
+struct FPlantableNeighbors
+{
+	static constexpr uint8 NumSlots = static_cast<uint8>(ENeighborLocationType::MAX);
+
+	APlantableObject* Get(ENeighborLocationType locationType) const { return mSlots[static_cast<uint8>(locationType)]; }
+	//A different neighbor in the slot hasn't been interacted with yet
+	void Set(ENeighborLocationType locationType, APlantableObject* neighbor)
+	{
+		const uint8 slot = static_cast<uint8>(locationType);
+		if (mSlots[slot] != neighbor)
+		{
+			mSlots[slot] = neighbor;
+			mInteractedMask &= ~(1 << slot);
+			MarkDebugLabelDirty();
+		}
+	}
+
+	bool HasInteractedWith(ENeighborLocationType locationType) const { return (mInteractedMask & (1 << static_cast<uint8>(locationType))) != 0; }
+	void MarkInteractedWith(ENeighborLocationType locationType) { mInteractedMask |= (1 << static_cast<uint8>(locationType)); MarkDebugLabelDirty(); }
+
+	APlantableObject* mSlots[NumSlots] = { nullptr, nullptr, nullptr, nullptr };
+	uint8 mInteractedMask = 0;
+
+#if ENABLE_DRAW_DEBUG
+	void MarkDebugLabelDirty() { mIsDebugLabelDirty = true; }
+
+	//Whether the owning plantable's cached debug label has to be rebuilt
+	mutable bool mIsDebugLabelDirty = true;
+#else
+	void MarkDebugLabelDirty() {}
+#endif
+};
+
+USTRUCT(BlueprintType)
+struct FPlantSignificanceSettings
+{
+	GENERATED_BODY()
+
+public:
+	FPlantSignificanceSettings();
+
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Enabled", Tooltip = "Let plantables off screen or far away go dormant"))
+	bool mIsEnabled;
+
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Dormant Distance", Tooltip = "Plantables further from the camera than this go dormant even when on screen"))
+	float mDormantDistance;
+
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Frustum Margin", ClampMin = "0", Tooltip = "Degrees added to the camera's field of view so plantables at the edge of the screen are already awake"))
+	float mFrustumMarginDegrees;
+
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Updates Per Frame", ClampMin = "1", Tooltip = "How many plantables have their significance updated each frame, going round all of them"))
+	int32 mUpdatesPerFrame;
+
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Dormant Evaluation Interval", ClampMin = "0", Tooltip = "Seconds between evaluating the interactions of dormant plantables"))
+	float mDormantEvaluationInterval;
+};
 
 UCLASS()
-class TEAMWOLVERINEPROJECT_API APlantableObject : public AActor
+class TEAMWOLVERINEPROJECT_API APlantableObject : public AActor, public IPoolableActor
 {
 	GENERATED_BODY()
 	public:	
 		APlantableObject();
 
-		virtual void Tick(float DeltaTime) override;
-
 		void SetNeighbor(APlantableObject* newNeighbor, ENeighborLocationType locationType);
 		void Grow();
-		void OnSpawn(ATile* closestTile, const TMap<ENeighborLocationType, APlantableObject*>& neighbors);
+		void OnSpawn(AObjectManagerComponent* objectManager, ATileGrid* tileGrid, int32 tileIndex, const FPlantableNeighbors& neighbors);
 		void OnInteractWithNeighbor(ENeighborLocationType locationTypeForNeighbor);
 		void OnInteractWithTile();
 
+		//Hands rendering of the stage meshes over to the instancer, the object's own mesh component is cleared.
+		void EnableInstancedRendering(UPlantableInstancer* instancer);
+
 		ETileType GetTileTypeForCurrentTile() const;
-		EPlantableObjectType GetObjectType() const { return mObjectType; }
-		const TMap<ENeighborLocationType, APlantableObject*>& GetNeighbors() { return mNeighbors; }
+		const UPlantableArchetype* GetArchetype() const { return mArchetype != nullptr ? mArchetype : GetDefault<UPlantableArchetype>(); }
+		EPlantableObjectType GetObjectType() const { return GetArchetype()->mObjectType; }
+		ESpawnTier GetSpawnTier() const { return GetArchetype()->mSpawnTier; }
+		int32 GetJournalIndex() const { return GetArchetype()->mIndex; }
+		UStaticMeshComponent* GetMeshComponent() const { return mMeshComponent; }
+		int32 GetCurrentTile() const { return mCurrentTile; }
+
+		//For when the object manager moves to a new tile grid
+		void SetCurrentTile(ATileGrid* tileGrid, int32 tileIndex);
+
+		//Handle into the object manager's registry
+		const FEntityHandle& GetEntityHandle() const { return mEntityHandle; }
+		void SetEntityHandle(const FEntityHandle& handle) { mEntityHandle = handle; }
+		const FPlantableNeighbors& GetNeighbors() const { return mNeighbors; }
 		bool HasInteractedWithNeighborBefore(ENeighborLocationType neighborLocationType) const;
 		bool HasInteractedWithCurrentTileBefore() const;
-		EGrowingStage mCurrentGrowingStage;
 
-		static ENeighborLocationType GetOppositeLocationType(ENeighborLocationType originalType);
+#if ENABLE_DRAW_DEBUG
+		//Its neighbors and what it has interacted with, for the debug overlay. Only rebuilt after those change.
+		const FString& GetDebugLabel() const;
+#endif
 
-		UPROPERTY(EditAnywhere, meta = (DisplayName = "Journal Index"))
-		int32 mIndex;
+		bool CanGrow() const;
+		float GetTimeUntilNextGrowingStage() const;
 
-		UPROPERTY(EditAnywhere, meta = (DisplayName = "Spawn Tier"))
-		ESpawnTier mSpawnTier;
+		//When the current stage is over, in growth scheduler time.
+		double GetGrowthDeadline() const { return mGrowthDeadline; }
+
+		//Grows through every stage whose deadline is passed once extraSeconds are added to currentTime, with one mesh update.
+		//Coalesced, that fires a single OnGrow/OnFinalGrow, otherwise one per stage grown (all seeing the final stage).
+		//Returns true if it grew, GetGrowthDeadline() is then the deadline of the stage it ended up in, in currentTime's clock.
+		bool AdvanceGrowth(double currentTime, double extraSeconds, bool coalesceGrowEvents);
+
+		UFUNCTION(BlueprintCallable, Category = "Growth", meta = (Tooltip = "Grows as if this many seconds had passed, without simulating them"))
+		void AdvanceTime(float seconds, bool coalesceGrowEvents = true);
+
+		//Dormant objects are off screen or far away, they don't grow until they wake and are evaluated less often.
+		bool IsDormant() const { return mIsDormant; }
+		void SetDormant(bool isDormant) { mIsDormant = isDormant; }
+
+		//Returns false if the object was already queued for an interaction update.
+		bool MarkQueuedForInteractionUpdate();
+		void ClearQueuedForInteractionUpdate() { mIsQueuedForInteractionUpdate = false; }
+		bool IsQueuedForInteractionUpdate() const { return mIsQueuedForInteractionUpdate; }
+
+		EGrowingStage mCurrentGrowingStage;
+
+		static ENeighborLocationType GetOppositeLocationType(ENeighborLocationType originalType);
 
 		UFUNCTION(BlueprintImplementableEvent, Category = "Interaction")
 		void OnGrow();
@@ -47,25 +149,77 @@ class TEAMWOLVERINEPROJECT_API APlantableObject : public AActor
 		UFUNCTION(BlueprintImplementableEvent, Category = "Interaction")
 		void OnFinalGrow();
 
+		//IPoolableActor
+		virtual void OnAcquiredFromPool() override;
+		virtual void OnReturnedToPool() override;
+
 	protected:
+		virtual void PostInitializeComponents() override;
 		virtual void BeginPlay() override;
+		virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+#if WITH_EDITOR
+		virtual void PostLoad() override;
+		virtual void PreSave(const class ITargetPlatform* TargetPlatform) override;
+		UPlantableArchetype* CreateArchetypeFromLegacyData();
+#endif
 
 	private:
+		friend class FGrowthScheduler;
+
 		bool SetMeshToMatchGrowingState();
 
-		TMap<ENeighborLocationType, APlantableObject*> mNeighbors;
-		TArray<ENeighborLocationType> mNeighborsWeHaveHadInteractionWith;
+		//Moves to the next stage that has a mesh, without updating the mesh. Returns false if there is none.
+		bool AdvanceToNextGrowingStage();
+		void OnGrown(int32 numStagesGrown, bool coalesceGrowEvents);
 
-		UPROPERTY(EditAnywhere, meta = (DisplayName = "Plantable Meshes", Tooltip = "The meshes that will be used for the different stages"))
-		TMap<EGrowingStage, UStaticMesh*> mPlantableMeshes;
+		FPlantableNeighbors mNeighbors;
+
+		UPROPERTY(EditDefaultsOnly, meta = (DisplayName = "Archetype", Tooltip = "Stage meshes, growing times and journal data shared by every plantable of this class"))
+		UPlantableArchetype* mArchetype;
 
-		ATile* mCurrentTile;
+		UPROPERTY()
+		UStaticMeshComponent* mMeshComponent;
 
-		UPROPERTY(EditAnywhere, meta = (DisplayName = "Object Type"))
+		//What the mesh component came with, so it can be restored when the object is reused from the pool.
+		UPROPERTY()
+		UStaticMesh* mDefaultMesh;
+		TEnumAsByte<ECollisionEnabled::Type> mDefaultCollision;
+
+		ATileGrid* mTileGrid;
+		int32 mCurrentTile;
+		AObjectManagerComponent* mObjectManager;
+		bool mIsQueuedForInteractionUpdate;
+		uint32 mGrowthTimerSerial;
+		double mGrowthDeadline;
+		bool mIsDormant;
+
+		FEntityHandle mEntityHandle;
+
+#if ENABLE_DRAW_DEBUG
+		mutable FString mDebugLabel;
+#endif
+
+		UPROPERTY()
+		UPlantableInstancer* mInstancer;
+		FPlantableInstanceHandle mInstanceHandle;
+
+#if WITH_EDITORONLY_DATA
+		//Per-instance settings from before archetypes, shown so they can be copied into an archetype asset.
+		//Only used to fill in a missing archetype in the editor, cooking fails without a real one.
+		UPROPERTY(VisibleDefaultsOnly, Category = "Legacy", meta = (DisplayName = "Plantable Meshes"))
+		TMap<EGrowingStage, UStaticMesh*> mPlantableMeshes;
+
+		UPROPERTY(VisibleDefaultsOnly, Category = "Legacy", meta = (DisplayName = "Object Type"))
 		EPlantableObjectType mObjectType;
 
-		UPROPERTY(EditAnywhere, meta = (DisplayName = "Time Until Next Growing Stage", Tooltip = "How much time it should take to get to the next growing stage, in seconds"))
-		float mTimeUntilNextGrowingStage; //TODO.PKH: Maybe add a different time for each stage??
+		UPROPERTY(VisibleDefaultsOnly, Category = "Legacy", meta = (DisplayName = "Time Until Next Growing Stage"))
+		float mTimeUntilNextGrowingStage;
 
-		float mTimeSpentInCurrentStage;
+		UPROPERTY(VisibleDefaultsOnly, Category = "Legacy", meta = (DisplayName = "Journal Index"))
+		int32 mIndex;
+
+		UPROPERTY(VisibleDefaultsOnly, Category = "Legacy", meta = (DisplayName = "Spawn Tier"))
+		ESpawnTier mSpawnTier;
+#endif
 };
@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameData.h"
+
+/**
+ * Picks a spawn tier (Common, Fancy or Mythical) from relative weights in constant time, using an alias table.
+ * The weights are normalized when the table is built, so they don't have to add up to 100.
+ */
+class TEAMWOLVERINEPROJECT_API FSpawnTierSampler
+{
+public:
+	static constexpr uint8 NumTiers = 3;
+
+	FSpawnTierSampler();
+
+	//If every weight is 0 it always picks Common.
+	void Build(float commonWeight, float fancyWeight, float mythicalWeight);
+
+	//random is uniform in [0, 1), it picks both the column and which side of it.
+	ESpawnTier Sample(float random) const;
+
+	//Chance of each tier after normalizing, in the same order as the weights.
+	float GetProbability(uint8 tierIndex) const { return mNormalizedWeights[tierIndex]; }
+
+	static ESpawnTier GetTier(uint8 tierIndex) { return static_cast<ESpawnTier>(static_cast<uint8>(ESpawnTier::Common) + tierIndex); }
+
+private:
+	//Chance of staying in each column rather than going to its alias
+	float mProbabilities[NumTiers];
+	uint8 mAliases[NumTiers];
+	float mNormalizedWeights[NumTiers];
+};
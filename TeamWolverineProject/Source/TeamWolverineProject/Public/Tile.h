@@ -8,6 +8,7 @@
 
 #include "Tile.generated.h"
 
+//Only used to author tiles, ATileGrid::BuildFromTileActors turns these into grid tiles at runtime.
 UCLASS()
 class TEAMWOLVERINEPROJECT_API ATile : public AActor
 {
@@ -16,18 +17,8 @@ class TEAMWOLVERINEPROJECT_API ATile : public AActor
 public:	
 	ATile();
 
-	virtual void Tick(float DeltaTime) override;
-
-	void OnInteractWithObjectOnTile();
-	void OnObjectSpawnOnTile();
-
 	ETileType GetTileType() const { return mTileType; }
-	bool HasBeenInteractedWith() const { return mHasBeenInteractedWith; }
 	bool IsTraversable() const { return mIsTraversable; }
-	bool IsUsed() const { return mIsUsed; }
-
-protected:
-	virtual void BeginPlay() override;
 
 private:	
 	UPROPERTY(EditAnywhere, Meta = (DisplayName="Tile Type"))
@@ -35,7 +26,4 @@ private:
 
 	UPROPERTY(EditAnywhere, Meta = (DisplayName = "Is Traversable"))
 	bool mIsTraversable;
-
-	bool mHasBeenInteractedWith;
-	bool mIsUsed;
 };
@@ -0,0 +1,154 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "GameData.h"
+
+#include "TileGrid.generated.h"
+
+class ATile;
+class UStaticMesh;
+class UMaterialInterface;
+class UHierarchicalInstancedStaticMeshComponent;
+
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnTileTraversabilityChanged, int32 /*tileIndex*/, bool /*isTraversable*/);
+
+USTRUCT()
+struct FTileDefinition
+{
+	GENERATED_BODY()
+
+public:
+	FTileDefinition();
+
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Tile Type"))
+	ETileType mTileType;
+
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Is Traversable"))
+	bool mIsTraversable;
+
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Mesh"))
+	UStaticMesh* mMesh;
+
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Material", Tooltip = "Optional, uses the mesh's own material if not set"))
+	UMaterialInterface* mMaterial;
+};
+
+/**
+ * All the tiles of a level as packed data, laid out row (X) major so that a tile's neighbors are found from its index.
+ * Every tile definition (grass corner/side/middle, stone, water...) is rendered by its own instanced mesh component.
+ */
+UCLASS()
+class TEAMWOLVERINEPROJECT_API ATileGrid : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ATileGrid();
+
+	//Converts tile actors placed or spawned the old way into grid tiles, destroying the actors.
+	UFUNCTION(BlueprintCallable, Category = "Tiles")
+	void BuildFromTileActors(const TArray<ATile*>& tiles);
+
+	//Builds a rows x columns grid, definitionIndices holds an index into Tile Definitions per tile, or -1 for no tile.
+	UFUNCTION(BlueprintCallable, Category = "Tiles")
+	void BuildFromDefinitions(const FVector& origin, float tileSize, int32 rows, int32 columns, const TArray<int32>& definitionIndices);
+
+	int32 Num() const { return mTiles.Num(); }
+	int32 GetRows() const { return mRows; }
+	int32 GetColumns() const { return mColumns; }
+	float GetTileSize() const { return mTileSize; }
+
+	int32 GetTileIndexForLocation(const FVector& location) const;
+	int32 GetNeighborTileIndex(int32 tileIndex, ENeighborLocationType locationType) const;
+	FVector GetTileLocation(int32 tileIndex) const;
+
+	//Valid tiles whose center is within the radius on the XY plane, only the cells around the center are checked.
+	void GetTilesInRadius(const FVector& center, float radius, TArray<int32>& outTileIndices) const;
+
+	bool IsValidTile(int32 tileIndex) const { return mTiles.IsValidIndex(tileIndex) && mTiles[tileIndex].mDefinitionIndex != NoDefinition; }
+	ETileType GetTileType(int32 tileIndex) const { return mTiles[tileIndex].mTileType; }
+	bool IsTraversable(int32 tileIndex) const { return HasFlag(tileIndex, TileFlag_Traversable); }
+	bool HasBeenInteractedWith(int32 tileIndex) const { return HasFlag(tileIndex, TileFlag_InteractedWith); }
+	bool IsUsed(int32 tileIndex) const { return HasFlag(tileIndex, TileFlag_Used); }
+
+	//Both are constant time, and return INDEX_NONE only if there is no such tile.
+	int32 GetRandomTraversableTile(const FRandomStream& randomStream) const { return mTraversableTiles.GetRandom(randomStream); }
+	int32 GetRandomFreeTile(const FRandomStream& randomStream) const { return mFreeTiles.GetRandom(randomStream); }
+
+	//Traversable tiles with no object on them
+	bool IsFree(int32 tileIndex) const { return IsValidTile(tileIndex) && IsTraversable(tileIndex) && !IsUsed(tileIndex); }
+	int32 GetNumFreeTiles() const { return mFreeTiles.Num(); }
+
+	void OnInteractWithObjectOnTile(int32 tileIndex);
+	void OnObjectSpawnOnTile(int32 tileIndex);
+	void OnObjectRemovedFromTile(int32 tileIndex);
+
+	UFUNCTION(BlueprintCallable, Category = "Tiles")
+	void SetTraversable(int32 tileIndex, bool isTraversable);
+
+	FOnTileTraversabilityChanged OnTraversabilityChanged;
+
+	//Broadcast after BuildFromTileActors or BuildFromDefinitions, every tile may have changed.
+	FSimpleMulticastDelegate OnGridRebuilt;
+
+private:
+	friend class UObjectManagerBenchmarkCommandlet;
+
+	static constexpr uint8 NoDefinition = MAX_uint8;
+
+	enum ETileFlags : uint8
+	{
+		TileFlag_Traversable = 1 << 0,
+		TileFlag_InteractedWith = 1 << 1,
+		TileFlag_Used = 1 << 2
+	};
+
+	struct FTileData
+	{
+		uint8 mDefinitionIndex = NoDefinition;
+		ETileType mTileType = ETileType::Grass;
+		uint8 mFlags = 0;
+	};
+
+	/** Tile indices with constant time add, remove and random pick, at the cost of an int per tile in the grid. */
+	struct FTileSet
+	{
+		void Reset(int32 numTiles);
+		void Add(int32 tileIndex);
+		void Remove(int32 tileIndex);
+		int32 GetRandom(const FRandomStream& randomStream) const { return mTileIndices.Num() > 0 ? mTileIndices[randomStream.RandRange(0, mTileIndices.Num() - 1)] : INDEX_NONE; }
+		int32 Num() const { return mTileIndices.Num(); }
+
+		TArray<int32> mTileIndices;
+
+		//Where each tile is in mTileIndices, INDEX_NONE if it isn't
+		TArray<int32> mPositions;
+	};
+
+	bool HasFlag(int32 tileIndex, ETileFlags flag) const { return (mTiles[tileIndex].mFlags & flag) != 0; }
+
+	//Adds the tile to, or removes it from, the tile sets to match its flags
+	void UpdateTileSets(int32 tileIndex);
+
+	void ResetGrid(const FVector& origin, float tileSize, int32 rows, int32 columns);
+	void SetTile(int32 tileIndex, int32 definitionIndex, const FTransform& instanceTransform);
+	int32 FindOrAddDefinition(ETileType tileType, bool isTraversable, UStaticMesh* mesh, UMaterialInterface* material);
+	UHierarchicalInstancedStaticMeshComponent* GetOrCreateMeshComponent(int32 definitionIndex);
+
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Tile Definitions"))
+	TArray<FTileDefinition> mTileDefinitions;
+
+	UPROPERTY(Transient)
+	TArray<UHierarchicalInstancedStaticMeshComponent*> mMeshComponents;
+
+	TArray<FTileData> mTiles;
+	FTileSet mTraversableTiles;
+	FTileSet mFreeTiles;
+	FVector mOrigin;
+	float mTileSize;
+	int32 mRows;
+	int32 mColumns;
+};
@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Engine/TargetPoint.h"
+#include "Misc/MemStack.h"
+
+#include "WaypointRegistry.generated.h"
+
+/**
+ * Every ATargetPoint in the world, gathered once and kept up to date as target points are spawned or destroyed.
+ * The waypoints are bucketed into a uniform grid of cells on the XY plane so spatial queries only look at nearby cells.
+ */
+UCLASS(NotPlaceable, Transient)
+class TEAMWOLVERINEPROJECT_API AWaypointRegistry : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AWaypointRegistry();
+
+	//Finds the registry for the world, spawning it the first time.
+	static AWaypointRegistry* Get(UWorld* world);
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	UFUNCTION(BlueprintCallable, Category = "Waypoints")
+	int32 Num() const { return mWaypoints.Num(); }
+
+	UFUNCTION(BlueprintCallable, Category = "Waypoints")
+	ATargetPoint* GetRandomWaypoint(const FRandomStream& randomStream) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Waypoints", meta = (Tooltip = "Picks a waypoint within the radius, closer ones being more likely"))
+	ATargetPoint* GetWeightedRandomWaypoint(const FVector& location, float radius, const FRandomStream& randomStream) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Waypoints", meta = (Tooltip = "Closest first"))
+	void FindNearestWaypoints(const FVector& location, int32 count, TArray<ATargetPoint*>& outWaypoints) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Waypoints")
+	void FindWaypointsInRadius(const FVector& location, float radius, TArray<ATargetPoint*>& outWaypoints) const;
+
+	void AddWaypoint(ATargetPoint* waypoint);
+
+	UFUNCTION()
+	void RemoveWaypoint(AActor* waypoint);
+
+private:
+	void GatherWaypoints();
+	void OnActorSpawned(AActor* actor);
+
+	FIntPoint GetCell(const FVector& location) const;
+	//Allocates from the memory stack, the caller has to hold a FMemMark
+	void FindWaypointIndicesInRadius(const FVector& location, float radius, TArray<int32, TMemStackAllocator<>>& outIndices) const;
+
+	UPROPERTY(EditAnywhere, meta = (DisplayName = "Cell Size", ClampMin = "100"))
+	float mCellSize;
+
+	UPROPERTY()
+	TArray<ATargetPoint*> mWaypoints;
+
+	//Same order as mWaypoints, target points don't move so their locations are only read once.
+	TArray<FVector> mWaypointLocations;
+
+	//Same order as mWaypoints, where each waypoint's index is in its cell's array
+	TArray<int32> mCellPositions;
+
+	//Index into mWaypoints, so removing a waypoint doesn't have to search for it
+	TMap<AActor*, int32> mWaypointIndices;
+
+	TMap<FIntPoint, TArray<int32>> mCells;
+	FIntPoint mMinCell;
+	FIntPoint mMaxCell;
+
+	FDelegateHandle mActorSpawnedHandle;
+
+	static TMap<TWeakObjectPtr<UWorld>, TWeakObjectPtr<AWaypointRegistry>> sRegistries;
+};